@@ -0,0 +1,208 @@
+#include "alchemy.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Order independent, the inventory lists the same ingredients in whatever order it likes
+static std::uint64_t HashIngredients(const Ingredient* const* ingredients, std::uint32_t count, std::uint32_t generation)
+{
+	std::uint64_t hash = 0x9E3779B97F4A7C15ull * (count + 1) + generation;
+	for(std::uint32_t i = 0; i < count; i++) {
+		std::uint64_t key = ingredients[i]->formID;
+		key ^= key >> 33;
+		key *= 0xFF51AFD7ED558CCDull;
+		key ^= key >> 33;
+		hash += key;
+	}
+	return hash ? hash : 1;
+}
+
+static std::uint32_t LowestBit(std::uint64_t value)
+{
+#ifdef _MSC_VER
+	// Win32 has no 64 bit scan
+	unsigned long index;
+	if(_BitScanForward(&index, static_cast<unsigned long>(value))) { return index; }
+	_BitScanForward(&index, static_cast<unsigned long>(value >> 32));
+	return index + 32;
+#else
+	return static_cast<std::uint32_t>(__builtin_ctzll(value));
+#endif
+}
+
+static float ScoreCombination(const Ingredient* const* parts, std::uint32_t numParts)
+{
+	// Effects at least two of the parts have
+	EffectSet active;
+	for(std::uint32_t a = 0; a < numParts; a++) {
+		for(std::uint32_t b = a + 1; b < numParts; b++) {
+			for(std::uint32_t w = 0; w < EffectSet::numWords; w++) active.words[w] |= parts[a]->effects.words[w] & parts[b]->effects.words[w];
+		}
+	}
+
+	std::uint16_t bits[3 * Ingredient::maxEffects];
+	float		  strengths[3 * Ingredient::maxEffects];
+	std::uint32_t numActive = 0;
+
+	for(std::uint32_t p = 0; p < numParts; p++) {
+		const Ingredient* part = parts[p];
+		for(std::uint32_t e = 0; e < part->numEffects; e++) {
+			if(!active.Test(part->effectBits[e])) { continue; }
+
+			std::uint32_t slot = 0;
+			while(slot < numActive && bits[slot] != part->effectBits[e]) { slot++; }
+			if(slot == numActive) {
+				bits[numActive]		 = part->effectBits[e];
+				strengths[numActive] = 0.0f;
+				numActive++;
+			}
+			strengths[slot] = std::max(strengths[slot], part->strengths[e]);
+		}
+	}
+
+	float score = 0.0f;
+	for(std::uint32_t i = 0; i < numActive; i++) score += strengths[i];
+	return score;
+}
+
+AlchemyResult AlchemySolver::Solve(Arena& arena, const Ingredient* const* ingredients, std::uint32_t count, std::uint32_t generation)
+{
+	std::lock_guard<std::mutex> guard(lock);
+
+	// Different lists can share a hash, only the same formIDs may reuse the result
+	std::uint64_t  key	   = HashIngredients(ingredients, count, generation);
+	std::uint32_t* formIDs = arena.AllocateArray<std::uint32_t>(count);
+	for(std::uint32_t i = 0; i < count; i++) formIDs[i] = ingredients[i]->formID;
+	std::sort(formIDs, formIDs + count);
+	if(key == cachedKey && generation == cachedGeneration && std::equal(formIDs, formIDs + count, cachedFormIDs.begin(), cachedFormIDs.end())) { return cached; }
+
+	AlchemyResult best = {};
+
+	// The ingredients having each effect, only ingredients in the same bucket share an effect
+	std::uint32_t* bucketStart = arena.AllocateArray<std::uint32_t>(EffectSet::maxBits + 1);
+	std::memset(bucketStart, 0, (EffectSet::maxBits + 1) * sizeof(std::uint32_t));
+	for(std::uint32_t i = 0; i < count; i++) {
+		for(std::uint32_t e = 0; e < ingredients[i]->numEffects; e++) bucketStart[ingredients[i]->effectBits[e] + 1]++;
+	}
+	for(std::uint32_t e = 0; e < EffectSet::maxBits; e++) bucketStart[e + 1] += bucketStart[e];
+
+	std::uint32_t* bucketFill = arena.AllocateArray<std::uint32_t>(EffectSet::maxBits);
+	std::uint32_t* buckets	  = arena.AllocateArray<std::uint32_t>(bucketStart[EffectSet::maxBits]);
+	std::memcpy(bucketFill, bucketStart, EffectSet::maxBits * sizeof(std::uint32_t));
+	for(std::uint32_t i = 0; i < count; i++) {
+		for(std::uint32_t e = 0; e < ingredients[i]->numEffects; e++) buckets[bucketFill[ingredients[i]->effectBits[e]]++] = i;
+	}
+
+	// Every pair sharing an effect is scored once. pairScores[i * count + j] is 0 for pairs
+	// sharing nothing, reach[i] is the best pair ingredient i is part of
+	std::uint32_t  words	  = (count + 63) / 64;
+	std::uint64_t* shared	  = arena.AllocateArray<std::uint64_t>(count * words);
+	float*		   pairScores = arena.AllocateArray<float>(count * count);
+	float*		   reach	  = arena.AllocateArray<float>(count);
+	std::memset(shared, 0, count * words * sizeof(std::uint64_t));
+	std::memset(pairScores, 0, count * count * sizeof(float));
+	std::memset(reach, 0, count * sizeof(float));
+
+	for(std::uint32_t e = 0; e < EffectSet::maxBits; e++) {
+		for(std::uint32_t x = bucketStart[e]; x < bucketStart[e + 1]; x++) {
+			for(std::uint32_t y = x + 1; y < bucketStart[e + 1]; y++) {
+				std::uint32_t i = buckets[x];
+				std::uint32_t j = buckets[y];
+				if((shared[i * words + (j >> 6)] >> (j & 63)) & 1) { continue; }
+
+				const Ingredient* parts[2] = {ingredients[i], ingredients[j]};
+				float			  score	   = ScoreCombination(parts, 2);
+				shared[i * words + (j >> 6)] |= 1ull << (j & 63);
+				shared[j * words + (i >> 6)] |= 1ull << (i & 63);
+				pairScores[i * count + j] = pairScores[j * count + i] = score;
+				reach[i]											  = std::max(reach[i], score);
+				reach[j]											  = std::max(reach[j], score);
+			}
+		}
+	}
+
+	// A triple scores at most the sum of its three pairs, every effect it has is shared by one
+	// of them at its strongest. Ingredients go by reach, strongest first, then the bound of
+	// every later combination only falls and the search stops once it cannot beat the best
+	std::uint32_t* order = arena.AllocateArray<std::uint32_t>(count);
+	for(std::uint32_t i = 0; i < count; i++) order[i] = i;
+	std::sort(order, order + count, [&](std::uint32_t a, std::uint32_t b) { return reach[a] > reach[b] || (reach[a] == reach[b] && ingredients[a]->formID < ingredients[b]->formID); });
+
+	// shares is shared in that order
+	std::uint64_t* shares = arena.AllocateArray<std::uint64_t>(count * words);
+	std::memset(shares, 0, count * words * sizeof(std::uint64_t));
+	for(std::uint32_t a = 0; a < count; a++) {
+		for(std::uint32_t b = a + 1; b < count; b++) {
+			if((shared[order[a] * words + (order[b] >> 6)] >> (order[b] & 63)) & 1) {
+				shares[a * words + (b >> 6)] |= 1ull << (b & 63);
+				shares[b * words + (a >> 6)] |= 1ull << (a & 63);
+			}
+		}
+	}
+
+	auto pairScore = [&](std::uint32_t a, std::uint32_t b) { return pairScores[order[a] * count + order[b]]; };
+	auto reachOf   = [&](std::uint32_t a) { return a < count ? reach[order[a]] : 0.0f; };
+
+	auto consider = [&](const Ingredient** parts, std::uint32_t numParts, float score) {
+		if(score > best.score) {
+			best.numIngredients = numParts;
+			best.score			= score;
+			for(std::uint32_t p = 0; p < numParts; p++) best.formIDs[p] = parts[p]->formID;
+		}
+	};
+
+	for(std::uint32_t i = 0; i < count; i++) {
+		if(3.0f * reachOf(i + 1) <= best.score) { break; }
+		const std::uint64_t* sharesI = shares + i * words;
+
+		for(std::uint32_t j = i + 1; j < count; j++) {
+			if(reachOf(j) + 2.0f * reachOf(j + 1) <= best.score) { break; }
+
+			const std::uint64_t* sharesJ = shares + j * words;
+			bool				 pairIJ	 = (sharesI[j >> 6] >> (j & 63)) & 1;
+			float				 scoreIJ = pairScore(i, j);
+
+			if(pairIJ) {
+				const Ingredient* parts[2] = {ingredients[order[i]], ingredients[order[j]]};
+				consider(parts, 2, scoreIJ);
+			}
+			if(scoreIJ + 2.0f * reachOf(j + 1) <= best.score) { continue; }
+
+			// The third ingredient has to share an effect with i or j, and both of those with
+			// one of the others, else one of them adds nothing
+			bool bounded = false;
+			for(std::uint32_t w = (j + 1) >> 6; w < words && !bounded; w++) {
+				std::uint64_t candidates = sharesI[w] | sharesJ[w];
+				if(w == (j + 1) >> 6) { candidates &= ~0ull << ((j + 1) & 63); }
+
+				while(candidates) {
+					std::uint32_t k = w * 64 + LowestBit(candidates);
+					candidates &= candidates - 1;
+
+					if(scoreIJ + 2.0f * reachOf(k) <= best.score) {
+						bounded = true;
+						break;
+					}
+					if(scoreIJ + pairScore(i, k) + pairScore(j, k) <= best.score) { continue; }
+
+					bool kSharesI = (sharesI[k >> 6] >> (k & 63)) & 1;
+					bool kSharesJ = (sharesJ[k >> 6] >> (k & 63)) & 1;
+					if(!(pairIJ || (kSharesI && kSharesJ))) { continue; }
+
+					const Ingredient* parts[3] = {ingredients[order[i]], ingredients[order[j]], ingredients[order[k]]};
+					consider(parts, 3, ScoreCombination(parts, 3));
+				}
+			}
+		}
+	}
+
+	cachedKey		 = key;
+	cachedGeneration = generation;
+	cached			 = best;
+	cachedFormIDs.assign(formIDs, formIDs + count);
+	return best;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "arena.h"
+
+/*
+EffectSet
+Bitset over the dense index the IngredientIndex hands out to every effect an ingredient
+can have. Effects past maxBits are dropped
+*/
+struct EffectSet
+{
+	static const std::uint32_t numWords = 4;
+	static const std::uint32_t maxBits	= numWords * 64;
+
+	std::uint64_t words[numWords] = {};
+
+	void Set(std::uint32_t bit) { words[bit >> 6] |= 1ull << (bit & 63); }
+	bool Test(std::uint32_t bit) const { return (words[bit >> 6] & (1ull << (bit & 63))) != 0; }
+
+	bool Intersects(const EffectSet& other) const
+	{
+		std::uint64_t shared = 0;
+		for(std::uint32_t i = 0; i < numWords; i++) shared |= other.words[i] & words[i];
+		return shared != 0;
+	}
+};
+
+struct Ingredient
+{
+	static const std::uint32_t maxEffects = 4;
+
+	std::uint32_t formID;
+	EffectSet	  effects;
+	std::uint32_t numEffects;
+	std::uint16_t effectBits[maxEffects];
+	float		  strengths[maxEffects];
+	float		  totalStrength;
+};
+
+struct AlchemyResult
+{
+	std::uint32_t numIngredients; // 0 when no two carried ingredients share an effect
+	std::uint32_t formIDs[3];
+	float		  score;
+};
+
+/*
+AlchemySolver
+Finds the strongest potion brewable from two or three of the carried ingredients. An effect
+ends up in the potion when at least two of its ingredients have it, the potion's score is the
+sum of those effects at the strength of the strongest ingredient having them.
+Only ingredients in one effect's bucket share an effect, every such pair is scored once. A
+triple scores at most the sum of its three pairs, so with the ingredients ordered by their
+best pair the search stops once that bound cannot beat the best so far. A third ingredient is
+only tried when it shares an effect with one of the other two. The result is kept until the set of ingredients changes,
+a matching hash is confirmed against the sorted formIDs it was computed for
+*/
+class AlchemySolver
+{
+	public:
+	// ingredients are the distinct ingredient kinds carried, in any order
+	AlchemyResult Solve(Arena& arena, const Ingredient* const* ingredients, std::uint32_t count, std::uint32_t generation);
+
+	private:
+	std::mutex				   lock;
+	std::uint64_t			   cachedKey		= 0;
+	std::uint32_t			   cachedGeneration = 0;
+	std::vector<std::uint32_t> cachedFormIDs;
+	AlchemyResult			   cached = {};
+};
@@ -0,0 +1,82 @@
+#include "allocaudit.h"
+
+#ifdef BICPP_ALLOCATION_AUDIT
+
+#include <cstdlib>
+#include <new>
+
+static thread_local std::size_t g_threadAllocations = 0;
+
+static void* CountedAllocate(std::size_t size)
+{
+	g_threadAllocations++;
+	return std::malloc(size ? size : 1);
+}
+
+void* operator new(std::size_t size)
+{
+	void* memory = CountedAllocate(size);
+	if(!memory) { throw std::bad_alloc(); }
+	return memory;
+}
+
+void* operator new[](std::size_t size)
+{
+	void* memory = CountedAllocate(size);
+	if(!memory) { throw std::bad_alloc(); }
+	return memory;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+	return CountedAllocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+	return CountedAllocate(size);
+}
+
+void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept
+{
+	std::free(memory);
+}
+
+bool AllocationAudit::IsEnabled()
+{
+	return true;
+}
+
+std::size_t AllocationAudit::GetThreadAllocations()
+{
+	return g_threadAllocations;
+}
+
+#else
+
+bool AllocationAudit::IsEnabled()
+{
+	return false;
+}
+
+std::size_t AllocationAudit::GetThreadAllocations()
+{
+	return 0;
+}
+
+#endif
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+
+/*
+Allocation Audit
+Building with BICPP_ALLOCATION_AUDIT defined replaces the global operator new with one that
+counts allocations per thread. ProcessInventory uses it to verify that a steady state pass
+performs no heap allocations. Without the define the counter always reads zero
+*/
+namespace AllocationAudit
+{
+	bool		IsEnabled();
+	std::size_t GetThreadAllocations();
+}
+
+class AllocationScope
+{
+	public:
+	AllocationScope() : start(AllocationAudit::GetThreadAllocations()) {}
+
+	std::size_t GetCount() const { return AllocationAudit::GetThreadAllocations() - start; }
+
+	private:
+	std::size_t start;
+};
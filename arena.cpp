@@ -0,0 +1,62 @@
+#include "arena.h"
+
+#include <algorithm>
+#include <new>
+
+Arena::Arena(std::size_t blockSize) : blockSize(blockSize)
+{
+	// The first block is allocated up front so a typical pass never touches the heap
+	AllocateSlow(0, 1);
+	Reset();
+}
+
+Arena::~Arena()
+{
+	Block* block = first;
+	while(block) {
+		Block* next = block->next;
+		::operator delete(block);
+		block = next;
+	}
+}
+
+void* Arena::AllocateSlow(std::size_t size, std::size_t alignment)
+{
+	// Blocks kept from earlier passes are reused in order before new ones are added
+	while(current && current->next) {
+		current = current->next;
+		offset	= 0;
+
+		std::uintptr_t base	   = reinterpret_cast<std::uintptr_t>(current + 1);
+		std::uintptr_t aligned = (base + alignment - 1) & ~(alignment - 1);
+		if(aligned + size <= base + current->size) {
+			offset = aligned + size - base;
+			return reinterpret_cast<void*>(aligned);
+		}
+	}
+
+	std::size_t capacity = std::max(blockSize, size + alignment);
+	Block*		block	 = static_cast<Block*>(::operator new(sizeof(Block) + capacity));
+	block->next			 = nullptr;
+	block->size			 = capacity;
+	blockAllocations++;
+
+	// Appended at the end so the chain order stays stable across passes
+	if(current) {
+		current->next = block;
+	} else {
+		first = block;
+	}
+	current = block;
+
+	std::uintptr_t base	   = reinterpret_cast<std::uintptr_t>(block + 1);
+	std::uintptr_t aligned = (base + alignment - 1) & ~(alignment - 1);
+	offset				   = aligned + size - base;
+	return reinterpret_cast<void*>(aligned);
+}
+
+void Arena::Reset()
+{
+	current = first;
+	offset	= 0;
+}
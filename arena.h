@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+Arena
+Bump allocator for scratch data that lives for one ProcessInventory pass. Reset rewinds to
+the first block but keeps every block, so once the largest inventory has been seen no pass
+allocates from the heap again. Individual deallocations are ignored
+*/
+class Arena
+{
+	public:
+	explicit Arena(std::size_t blockSize = 64 * 1024);
+	~Arena();
+
+	Arena(const Arena&) = delete;
+	Arena& operator=(const Arena&) = delete;
+
+	void* Allocate(std::size_t size, std::size_t alignment)
+	{
+		if(current) {
+			std::uintptr_t base	   = reinterpret_cast<std::uintptr_t>(current + 1);
+			std::uintptr_t aligned = (base + offset + alignment - 1) & ~(alignment - 1);
+			if(aligned + size <= base + current->size) {
+				offset = aligned + size - base;
+				return reinterpret_cast<void*>(aligned);
+			}
+		}
+		return AllocateSlow(size, alignment);
+	}
+
+	template<class T>
+	T* AllocateArray(std::size_t count)
+	{
+		return static_cast<T*>(Allocate(count * sizeof(T), alignof(T)));
+	}
+
+	void Reset();
+
+	std::size_t GetBlockAllocations() const { return blockAllocations; }
+
+	private:
+	struct alignas(16) Block
+	{
+		Block*		next;
+		std::size_t size;
+	};
+
+	void* AllocateSlow(std::size_t size, std::size_t alignment);
+
+	Block*		first			 = nullptr;
+	Block*		current			 = nullptr;
+	std::size_t offset			 = 0;
+	std::size_t blockSize		 = 0;
+	std::size_t blockAllocations = 0;
+};
+
+// Rewinds the arena when the pass leaves scope, whichever way it leaves
+class ArenaScope
+{
+	public:
+	explicit ArenaScope(Arena& arena) : arena(arena) {}
+	~ArenaScope() { arena.Reset(); }
+
+	private:
+	Arena& arena;
+};
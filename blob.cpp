@@ -0,0 +1,149 @@
+#include "blob.h"
+
+#include <cstring>
+#include <type_traits>
+
+static_assert(std::is_trivially_copyable<RuleRow>::value, "RuleRow is written to the blob as is");
+static_assert(std::is_trivially_copyable<CategoryDef>::value, "CategoryDef is written to the blob as is");
+static_assert(sizeof(BlobHeader) % 8 == 0, "Sections after the header need 8 byte alignment");
+
+// FNV-1a
+static std::uint64_t Hash64(const std::uint8_t* data, std::size_t length)
+{
+	std::uint64_t hash = 0xCBF29CE484222325ull;
+	for(std::size_t i = 0; i < length; i++) {
+		hash ^= data[i];
+		hash *= 0x100000001B3ull;
+	}
+	return hash;
+}
+
+static std::uint32_t Checksum(const std::uint8_t* data, std::size_t length)
+{
+	std::uint64_t hash = Hash64(data, length);
+	return static_cast<std::uint32_t>(hash ^ (hash >> 32));
+}
+
+static std::uint32_t AlignUp(std::uint32_t value)
+{
+	return (value + 7) & ~7u;
+}
+
+std::uint64_t HashRuleSource(const char* text, std::size_t length)
+{
+	return Hash64(reinterpret_cast<const std::uint8_t*>(text), length);
+}
+
+void WriteRuleBlob(const RuleTable& table, std::uint64_t sourceHash, std::uint32_t sourceSize, std::vector<std::uint8_t>& out)
+{
+	BlobHeader header = {};
+	header.magic		= BlobHeader::magicValue;
+	header.version		= BlobHeader::formatVersion;
+	header.headerSize	= sizeof(BlobHeader);
+	header.rowSize		= sizeof(RuleRow);
+	header.categorySize	= sizeof(CategoryDef);
+	header.sourceSize	= sourceSize;
+	header.sourceHash	= sourceHash;
+
+	header.rowOffset	   = sizeof(BlobHeader);
+	header.numRows		   = table.numRows;
+	header.kindRowOffset   = AlignUp(header.rowOffset + table.numRows * sizeof(RuleRow));
+	header.numKindRows	   = table.kindStart[RuleTable::numKinds];
+	header.kindStartOffset = AlignUp(header.kindRowOffset + header.numKindRows * sizeof(RuleRow));
+	header.categoryOffset  = AlignUp(header.kindStartOffset + (RuleTable::numKinds + 1) * sizeof(std::uint32_t));
+	header.numCategories   = table.numCategories;
+	header.keywordOffset   = AlignUp(header.categoryOffset + table.numCategories * sizeof(CategoryDef));
+	header.numKeywords	   = table.numKeywords;
+	header.totalSize	   = AlignUp(header.keywordOffset + table.numKeywords * sizeof(std::uint32_t));
+
+	out.assign(header.totalSize, 0);
+	if(table.numRows) { std::memcpy(&out[header.rowOffset], table.rows, table.numRows * sizeof(RuleRow)); }
+	if(header.numKindRows) { std::memcpy(&out[header.kindRowOffset], table.kindRows, header.numKindRows * sizeof(RuleRow)); }
+	std::memcpy(&out[header.kindStartOffset], table.kindStart, (RuleTable::numKinds + 1) * sizeof(std::uint32_t));
+	if(table.numCategories) { std::memcpy(&out[header.categoryOffset], table.categories, table.numCategories * sizeof(CategoryDef)); }
+	if(table.numKeywords) { std::memcpy(&out[header.keywordOffset], table.keywordFormIDs, table.numKeywords * sizeof(std::uint32_t)); }
+
+	header.checksum = Checksum(out.data() + sizeof(BlobHeader), out.size() - sizeof(BlobHeader));
+	std::memcpy(out.data(), &header, sizeof(BlobHeader));
+}
+
+static bool SectionFits(std::uint32_t offset, std::uint32_t count, std::uint32_t elementSize, std::uint32_t totalSize)
+{
+	return offset % 8 == 0 && offset <= totalSize && static_cast<std::uint64_t>(count) * elementSize <= totalSize - offset;
+}
+
+bool ReadRuleBlob(const std::uint8_t* data, std::size_t size, RuleTable& table, const BlobHeader*& header, std::string& error)
+{
+	if(!data || size < sizeof(BlobHeader)) {
+		error = "file is too small";
+		return false;
+	}
+
+	header = reinterpret_cast<const BlobHeader*>(data);
+
+	if(header->magic != BlobHeader::magicValue) {
+		error = "not a rule blob";
+		return false;
+	}
+	if(header->version != BlobHeader::formatVersion || header->headerSize != sizeof(BlobHeader) || header->rowSize != sizeof(RuleRow) || header->categorySize != sizeof(CategoryDef)) {
+		error = "compiled for format version " + std::to_string(header->version) + ", expected " + std::to_string(BlobHeader::formatVersion);
+		return false;
+	}
+	if(header->totalSize != size) {
+		error = "size mismatch, the file is truncated";
+		return false;
+	}
+	if(!SectionFits(header->rowOffset, header->numRows, sizeof(RuleRow), header->totalSize) || !SectionFits(header->kindRowOffset, header->numKindRows, sizeof(RuleRow), header->totalSize) ||
+	   !SectionFits(header->kindStartOffset, RuleTable::numKinds + 1, sizeof(std::uint32_t), header->totalSize) || !SectionFits(header->categoryOffset, header->numCategories, sizeof(CategoryDef), header->totalSize) ||
+	   !SectionFits(header->keywordOffset, header->numKeywords, sizeof(std::uint32_t), header->totalSize)) {
+		error = "section out of bounds";
+		return false;
+	}
+	if(header->numKeywords > KeywordSet::maxBits || header->numCategories == 0) {
+		error = "invalid section counts";
+		return false;
+	}
+	if(Checksum(data + sizeof(BlobHeader), size - sizeof(BlobHeader)) != header->checksum) {
+		error = "checksum mismatch";
+		return false;
+	}
+
+	table.rows			 = reinterpret_cast<const RuleRow*>(data + header->rowOffset);
+	table.numRows		 = header->numRows;
+	table.kindRows		 = reinterpret_cast<const RuleRow*>(data + header->kindRowOffset);
+	table.kindStart		 = reinterpret_cast<const std::uint32_t*>(data + header->kindStartOffset);
+	table.categories	 = reinterpret_cast<const CategoryDef*>(data + header->categoryOffset);
+	table.numCategories	 = header->numCategories;
+	table.keywordFormIDs = reinterpret_cast<const std::uint32_t*>(data + header->keywordOffset);
+	table.numKeywords	 = header->numKeywords;
+
+	// A row pointing past the category table would index out of bounds during a pass
+	for(std::uint32_t i = 0; i < table.numRows; i++) {
+		if(table.rows[i].category >= table.numCategories) {
+			error = "rule " + std::to_string(i) + " references an unknown category";
+			return false;
+		}
+	}
+	for(std::uint32_t i = 0; i < header->numKindRows; i++) {
+		if(table.kindRows[i].category >= table.numCategories) {
+			error = "rule " + std::to_string(i) + " of the kind ranges references an unknown category";
+			return false;
+		}
+	}
+
+	// Classify walks kindStart[k] up to kindStart[k + 1], both have to stay inside kindRows
+	for(std::uint32_t k = 0; k < RuleTable::numKinds; k++) {
+		if(table.kindStart[k] > table.kindStart[k + 1] || table.kindStart[k + 1] > header->numKindRows) {
+			error = "the rule ranges of the item kinds are malformed";
+			return false;
+		}
+	}
+	for(std::uint32_t i = 0; i < table.numCategories; i++) {
+		if(table.categories[i].name[CategoryDef::maxNameLength] != '\0' || table.categories[i].metric >= kMetric_Count) {
+			error = "category " + std::to_string(i) + " is malformed";
+			return false;
+		}
+	}
+
+	return true;
+}
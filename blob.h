@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "rules.h"
+
+/*
+Rule Blob
+A compiled RuleTable written out as one flat block, loaded by mapping the file and pointing
+a RuleTable straight into it. All sections are addressed by offsets from the start of the
+blob, so it does not matter where it is mapped.
+
+	BlobHeader
+	RuleRow		rows[numRows]			at rowOffset
+	RuleRow		kindRows[numKindRows]		at kindRowOffset
+	uint32		kindStart[RuleTable::numKinds + 1]	at kindStartOffset
+	CategoryDef	categories[numCategories]	at categoryOffset
+	uint32		keywordFormIDs[numKeywords]	at keywordOffset
+
+The checksum covers everything after the header. sourceHash is the hash of the rule text
+the blob was compiled from, a blob whose source changed since is considered stale.
+*/
+struct BlobHeader
+{
+	static const std::uint32_t magicValue	= 0x52434942; // "BICR"
+	static const std::uint32_t formatVersion = 3;
+
+	std::uint32_t magic;
+	std::uint32_t version;
+	std::uint32_t headerSize;
+	std::uint32_t rowSize;
+	std::uint32_t categorySize;
+	std::uint32_t totalSize;
+	std::uint32_t checksum;
+	std::uint32_t sourceSize;
+	std::uint64_t sourceHash;
+	std::uint32_t rowOffset;
+	std::uint32_t numRows;
+	std::uint32_t kindRowOffset;
+	std::uint32_t numKindRows;
+	std::uint32_t kindStartOffset;
+	std::uint32_t categoryOffset;
+	std::uint32_t numCategories;
+	std::uint32_t keywordOffset;
+	std::uint32_t numKeywords;
+};
+
+std::uint64_t HashRuleSource(const char* text, std::size_t length);
+
+void WriteRuleBlob(const RuleTable& table, std::uint64_t sourceHash, std::uint32_t sourceSize, std::vector<std::uint8_t>& out);
+
+// Validates the blob and points table into it, nothing is copied or allocated
+bool ReadRuleBlob(const std::uint8_t* data, std::size_t size, RuleTable& table, const BlobHeader*& header, std::string& error);
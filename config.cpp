@@ -0,0 +1,283 @@
+#include "config.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+static std::string ToLower(std::string text)
+{
+	std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+	return text;
+}
+
+static std::string Trim(const std::string& text)
+{
+	std::size_t first = text.find_first_not_of(" \t\r\n");
+	if(first == std::string::npos) { return std::string(); }
+	std::size_t last = text.find_last_not_of(" \t\r\n");
+	return text.substr(first, last - first + 1);
+}
+
+bool IniFile::Load(const char* path, std::string& error)
+{
+	std::ifstream file(path);
+	if(!file) {
+		error = std::string("could not open \"") + path + "\"";
+		return false;
+	}
+
+	std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	return Parse(text, error);
+}
+
+bool IniFile::Parse(const std::string& text, std::string& error)
+{
+	values.clear();
+
+	std::string section;
+	std::size_t start	   = 0;
+	int			lineNumber = 0;
+
+	while(start <= text.size()) {
+		std::size_t end = text.find('\n', start);
+		if(end == std::string::npos) { end = text.size(); }
+		std::string line = Trim(text.substr(start, end - start));
+		start			 = end + 1;
+		lineNumber++;
+
+		if(line.empty() || line[0] == ';' || line[0] == '#') { continue; }
+
+		if(line[0] == '[') {
+			std::size_t close = line.find(']');
+			if(close == std::string::npos) {
+				error = "line " + std::to_string(lineNumber) + ": missing ']'";
+				return false;
+			}
+			section = ToLower(Trim(line.substr(1, close - 1)));
+			continue;
+		}
+
+		std::size_t equals = line.find('=');
+		if(equals == std::string::npos) {
+			error = "line " + std::to_string(lineNumber) + ": expected 'key = value'";
+			return false;
+		}
+
+		// Trailing comments are only stripped when separated by whitespace, paths may contain ';'
+		std::string value	= Trim(line.substr(equals + 1));
+		std::size_t comment = value.find(" ;");
+		if(comment != std::string::npos) { value = Trim(value.substr(0, comment)); }
+
+		values[section + "." + ToLower(Trim(line.substr(0, equals)))] = value;
+	}
+
+	return true;
+}
+
+const std::string* IniFile::Find(const char* section, const char* key) const
+{
+	auto it = values.find(ToLower(section) + "." + ToLower(key));
+	return it != values.end() ? &it->second : nullptr;
+}
+
+std::string IniFile::GetString(const char* section, const char* key, const char* defaultValue) const
+{
+	const std::string* value = Find(section, key);
+	return value ? *value : std::string(defaultValue);
+}
+
+bool IniFile::GetBool(const char* section, const char* key, bool defaultValue) const
+{
+	const std::string* value = Find(section, key);
+	if(!value || value->empty()) { return defaultValue; }
+
+	std::string lower = ToLower(*value);
+	return lower == "1" || lower == "true" || lower == "yes" || lower == "on";
+}
+
+std::int32_t IniFile::GetInt(const char* section, const char* key, std::int32_t defaultValue) const
+{
+	const std::string* value = Find(section, key);
+	return value && !value->empty() ? static_cast<std::int32_t>(std::strtol(value->c_str(), nullptr, 0)) : defaultValue;
+}
+
+float IniFile::GetFloat(const char* section, const char* key, float defaultValue) const
+{
+	const std::string* value = Find(section, key);
+	return value && !value->empty() ? static_cast<float>(std::strtod(value->c_str(), nullptr)) : defaultValue;
+}
+
+void Settings::Read(const IniFile& ini)
+{
+	rulesPath		  = ini.GetString("General", "sRulesFile", rulesPath.c_str());
+	rulesBlobPath	  = ini.GetString("General", "sRulesBlob", rulesBlobPath.c_str());
+	verboseLogging	  = ini.GetBool("General", "bVerboseLogging", verboseLogging);
+	showEquippedDelta = ini.GetBool("General", "bShowEquippedDelta", showEquippedDelta);
+	rankPotions		  = ini.GetBool("General", "bRankPotions", rankPotions);
+	suggestAlchemy	  = ini.GetBool("General", "bSuggestAlchemy", suggestAlchemy);
+	watchFiles		  = ini.GetBool("General", "bWatchFiles", watchFiles);
+	pollIntervalMs	  = static_cast<std::uint32_t>(std::max(100, ini.GetInt("General", "iPollIntervalMs", pollIntervalMs)));
+	prefetchDistance  = static_cast<std::uint32_t>(std::min(64, std::max(0, ini.GetInt("Performance", "iPrefetchDistance", prefetchDistance))));
+	skipRankedLists	  = ini.GetBool("Performance", "bSkipRankedLists", skipRankedLists);
+	loadoutEnabled	  = ini.GetBool("Loadout", "bEnabled", loadoutEnabled);
+	loadoutMaxWeight  = std::max(0.0f, ini.GetFloat("Loadout", "fMaxWeight", loadoutMaxWeight));
+	loadoutWeightStep = std::max(0.01f, ini.GetFloat("Loadout", "fWeightStep", loadoutWeightStep));
+	shadowEnabled	  = ini.GetBool("Shadow", "bEnabled", shadowEnabled);
+	shadowSnapshot	  = ini.GetString("Shadow", "sSnapshotFile", shadowSnapshot.c_str());
+	watchdogBudgetMs  = std::max(0.0f, ini.GetFloat("Watchdog", "fBudgetMs", watchdogBudgetMs));
+	snapshotDirectory = ini.GetString("Watchdog", "sSnapshotDir", snapshotDirectory.c_str());
+	maxSnapshots	  = static_cast<std::uint32_t>(std::min(100, std::max(1, ini.GetInt("Watchdog", "iMaxSnapshots", maxSnapshots))));
+	traceEnabled	  = ini.GetBool("FlightRecorder", "bEnabled", traceEnabled);
+	traceDumpFile	  = ini.GetString("FlightRecorder", "sDumpFile", traceDumpFile.c_str());
+	traceTrigger	  = ini.GetString("FlightRecorder", "sDumpTrigger", traceTrigger.c_str());
+	traceDumpOnCrash  = ini.GetBool("FlightRecorder", "bDumpOnCrash", traceDumpOnCrash);
+	logCollapse		  = ini.GetBool("Logging", "bCollapseRepeats", logCollapse);
+	logRateBurst	  = static_cast<std::uint32_t>(std::min(65535, std::max(1, ini.GetInt("Logging", "iRateBurst", logRateBurst))));
+	logRatePerSec	  = static_cast<std::uint32_t>(std::max(0, ini.GetInt("Logging", "iRatePerSecond", logRatePerSec)));
+	logMapped		  = ini.GetBool("Logging", "bMappedLog", logMapped);
+	logMappedPath	  = ini.GetString("Logging", "sMappedLogFile", logMappedPath.c_str());
+	logSegmentKB	  = static_cast<std::uint32_t>(std::min(1024 * 1024, std::max(64, ini.GetInt("Logging", "iSegmentKB", logSegmentKB))));
+	logSegments		  = static_cast<std::uint32_t>(std::min(100, std::max(1, ini.GetInt("Logging", "iSegments", logSegments))));
+	logCompress		  = ini.GetBool("Logging", "bCompressLog", logCompress);
+}
+
+// Modification times in nanoseconds since 1970, -1 for a missing file
+static void GetFileState(const std::string& path, std::int64_t& modified, std::int64_t& size)
+{
+	modified = -1;
+	size	 = -1;
+
+#ifdef _WIN32
+	// FILETIME counts 100 ns from 1601, _stat64 would round it to seconds
+	WIN32_FILE_ATTRIBUTE_DATA info;
+	if(!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &info)) { return; }
+
+	std::int64_t ticks = (static_cast<std::int64_t>(info.ftLastWriteTime.dwHighDateTime) << 32) | info.ftLastWriteTime.dwLowDateTime;
+	modified		   = (ticks - 116444736000000000ll) * 100;
+	size			   = (static_cast<std::int64_t>(info.nFileSizeHigh) << 32) | info.nFileSizeLow;
+#else
+	struct stat info;
+	if(stat(path.c_str(), &info) != 0) { return; }
+
+	modified = static_cast<std::int64_t>(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+	size	 = static_cast<std::int64_t>(info.st_size);
+#endif
+}
+
+// FNV-1a of the file's contents, 0 for a missing file
+static std::uint64_t HashFile(const std::string& path)
+{
+	std::ifstream file(path, std::ios::binary);
+	if(!file) { return 0; }
+
+	std::uint64_t hash = 0xCBF29CE484222325ull;
+	char		  buffer[4096];
+	while(file.read(buffer, sizeof(buffer)) || file.gcount()) {
+		for(std::streamsize i = 0; i < file.gcount(); i++) {
+			hash ^= static_cast<std::uint8_t>(buffer[i]);
+			hash *= 0x100000001B3ull;
+		}
+	}
+	return hash;
+}
+
+// A file may still be written within the same tick of its modification time, until that time is
+// older than the coarsest clock a filesystem keeps, FAT's two seconds, its contents are compared
+static const std::int64_t kRacyNs = 2000000000;
+
+static bool IsRacy(std::int64_t modified)
+{
+	std::int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	return modified != -1 && now - modified < kRacyNs;
+}
+
+void FileWatcher::SetPaths(const std::vector<std::string>& paths)
+{
+	std::vector<Entry> updated;
+	for(const std::string& path : paths) {
+		Entry entry;
+		entry.path = path;
+		entry.hash = HashFile(path);
+		GetFileState(path, entry.modified, entry.size);
+		entry.racy = IsRacy(entry.modified);
+		updated.push_back(entry);
+	}
+
+	std::lock_guard<std::mutex> guard(lock);
+	entries.swap(updated);
+}
+
+std::string FileWatcher::GetPath(std::size_t i)
+{
+	std::lock_guard<std::mutex> guard(lock);
+	return i < entries.size() ? entries[i].path : std::string();
+}
+
+bool FileWatcher::Poll()
+{
+	std::lock_guard<std::mutex> guard(lock);
+
+	bool changed = false;
+	for(Entry& entry : entries) {
+		std::int64_t modified, size;
+		GetFileState(entry.path, modified, size);
+
+		bool stateChanged = modified != entry.modified || size != entry.size;
+		if(!stateChanged && !entry.racy) { continue; }
+
+		// An edit within the tick of the last one only shows in the contents
+		std::uint64_t hash = HashFile(entry.path);
+		changed			   = changed || stateChanged || hash != entry.hash;
+		entry.modified	   = modified;
+		entry.size		   = size;
+		entry.hash		   = hash;
+		entry.racy		   = IsRacy(modified);
+	}
+	return changed;
+}
+
+void FileWatcher::Start(std::uint32_t interval, Callback onChange)
+{
+	Stop();
+
+	std::lock_guard<std::mutex> guard(lock);
+	intervalMs = interval;
+	callback   = onChange;
+	running	   = true;
+	thread	   = std::thread(&FileWatcher::Run, this);
+}
+
+void FileWatcher::Stop()
+{
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		if(!running) { return; }
+		running = false;
+	}
+
+	wake.notify_all();
+	if(thread.joinable()) { thread.join(); }
+}
+
+void FileWatcher::Run()
+{
+	std::unique_lock<std::mutex> guard(lock);
+
+	while(running) {
+		wake.wait_for(guard, std::chrono::milliseconds(intervalMs), [this] { return !running; });
+		if(!running) { break; }
+
+		// The callback may replace the watched paths, so it must run unlocked
+		guard.unlock();
+		if(Poll() && callback) { callback(); }
+		guard.lock();
+	}
+}
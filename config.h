@@ -0,0 +1,220 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "keywords.h"
+#include "mappedfile.h"
+#include "potions.h"
+#include "rules.h"
+#include "scoring.h"
+
+/*
+IniFile
+Minimal INI reader, [Section] headers, key = value pairs and ; or # comments.
+Section and key names are case insensitive, like the game's own INI files
+*/
+class IniFile
+{
+	public:
+	bool Load(const char* path, std::string& error);
+	bool Parse(const std::string& text, std::string& error);
+
+	std::string	  GetString(const char* section, const char* key, const char* defaultValue) const;
+	bool		  GetBool(const char* section, const char* key, bool defaultValue) const;
+	std::int32_t  GetInt(const char* section, const char* key, std::int32_t defaultValue) const;
+	float		  GetFloat(const char* section, const char* key, float defaultValue) const;
+
+	private:
+	const std::string* Find(const char* section, const char* key) const;
+
+	std::unordered_map<std::string, std::string> values;
+};
+
+struct Settings
+{
+	std::string	  rulesPath			= "Data\\SKSE\\Plugins\\BestInClassPP_Rules.txt";
+	std::string	  rulesBlobPath		= "Data\\SKSE\\Plugins\\BestInClassPP_Rules.bin";
+	bool		  verboseLogging	= true;
+	bool		  showEquippedDelta	= false;
+	bool		  rankPotions		= true;
+	bool		  suggestAlchemy	= true;
+	bool		  watchFiles		= true;
+	std::uint32_t pollIntervalMs	= 1000;
+	std::uint32_t prefetchDistance	= 0;
+	bool		  skipRankedLists	= true;
+	bool		  loadoutEnabled	= false;
+	float		  loadoutMaxWeight	= 60.0f;
+	float		  loadoutWeightStep	= 0.5f;
+	bool		  shadowEnabled		= false;
+	std::string	  shadowSnapshot	= "Data\\SKSE\\Plugins\\BestInClassPP_Shadow.txt";
+	float		  watchdogBudgetMs	= 8.0f;
+	std::string	  snapshotDirectory	= "Data\\SKSE\\Plugins\\BestInClassPP_Snapshots";
+	std::uint32_t maxSnapshots		= 10;
+	bool		  traceEnabled		= true;
+	std::string	  traceDumpFile		= "Data\\SKSE\\Plugins\\BestInClassPP_Trace.txt";
+	std::string	  traceTrigger		= "Data\\SKSE\\Plugins\\BestInClassPP_DumpTrace";
+	bool		  traceDumpOnCrash	= true;
+	bool		  logCollapse		= true;
+	std::uint32_t logRateBurst		= 200;
+	std::uint32_t logRatePerSec		= 100;
+	bool		  logMapped			= false;
+	std::string	  logMappedPath		= "Data\\SKSE\\Plugins\\BestInClassPP_Mapped.log";
+	std::uint32_t logSegmentKB		= 4096;
+	std::uint32_t logSegments		= 5;
+	bool		  logCompress		= false;
+
+	void Read(const IniFile& ini);
+};
+
+/*
+ConfigSnapshot
+Everything ProcessInventory reads, built in full by a reload and never modified after
+being published. The rule table points either into the compiled rules or into the
+mapped rule blob, both owned by the snapshot
+*/
+struct ConfigSnapshot
+{
+	Settings		settings;
+	RuleProgram		rules;
+	MappedFile		rulesBlob;
+	RuleTable		table;
+	ScoreWeights	weights;
+	KeywordIndex	keywords;
+	PotionIndex		potions;
+	IngredientIndex	ingredients;
+	std::string		rulesSource; // The rule file the table was built from, or "(built-in)"
+	std::uint64_t	rulesHash  = 0;
+	std::uint32_t	generation = 0;
+};
+
+/*
+GameIndex
+What data load indexes on the game thread. Reloads copy the potions and ingredients and map
+their keywords through the catalog, none of them touches the game data again
+*/
+struct GameIndex
+{
+	KeywordCatalog	keywords;
+	PotionIndex		potions;
+	IngredientIndex	ingredients;
+};
+
+/*
+SnapshotSlot
+Readers take a Reader, which counts them in and loads the current pointer, and never block.
+Publishing swaps the pointer and retires the old snapshot instead of deleting it, since a
+reader may still be using it. A reader counted in after the swap can only get the new
+snapshot, so once a publish finds no reader at all every retired snapshot is freed
+*/
+template<class T>
+class SnapshotSlot
+{
+	public:
+	class Reader
+	{
+		public:
+		explicit Reader(SnapshotSlot& slot) : slot(slot)
+		{
+			slot.readers.fetch_add(1);
+			snapshot = slot.current.load();
+		}
+		~Reader() { slot.readers.fetch_sub(1); }
+
+		Reader(const Reader&) = delete;
+		Reader& operator=(const Reader&) = delete;
+
+		const T* Get() const { return snapshot; }
+
+		private:
+		SnapshotSlot& slot;
+		const T*	  snapshot;
+	};
+
+	~SnapshotSlot()
+	{
+		delete current.load(std::memory_order_relaxed);
+		for(T* snapshot : retired) delete snapshot;
+	}
+
+	void Publish(std::unique_ptr<T> snapshot)
+	{
+		std::lock_guard<std::mutex> guard(writerLock);
+
+		T* previous = current.exchange(snapshot.release());
+		if(previous) { retired.push_back(previous); }
+
+		// Sequentially consistent with the readers' count and load, a reader this misses loads the new pointer
+		if(readers.load() == 0) {
+			for(T* unused : retired) delete unused;
+			retired.clear();
+		}
+	}
+
+	std::size_t GetNumRetired()
+	{
+		std::lock_guard<std::mutex> guard(writerLock);
+		return retired.size();
+	}
+
+	private:
+	std::atomic<T*>			   current{nullptr};
+	std::atomic<std::uint32_t> readers{0};
+	std::mutex				   writerLock;
+	std::vector<T*>			   retired;
+};
+
+/*
+FileWatcher
+Polls the modification time and size of a set of files from a background thread and
+invokes the callback, outside of its own lock, whenever one of them changes. Times are read to
+the filesystem's resolution, below a second, and a file modified within the last two seconds
+has its contents hashed as well, an edit within the same tick still shows
+*/
+class FileWatcher
+{
+	public:
+	typedef std::function<void()> Callback;
+
+	~FileWatcher() { Stop(); }
+
+	void Start(std::uint32_t intervalMs, Callback onChange);
+	void Stop();
+
+	// Replaces the watched files, their current state becomes the baseline
+	void SetPaths(const std::vector<std::string>& paths);
+
+	// The i-th watched path, empty past the last one
+	std::string GetPath(std::size_t i);
+
+	// Checks the files once, returns true if any changed since the last check
+	bool Poll();
+
+	private:
+	struct Entry
+	{
+		std::string	  path;
+		std::int64_t  modified; // Nanoseconds since 1970, -1 for a missing file
+		std::int64_t  size;
+		std::uint64_t hash;		// Of the contents
+		bool		  racy;		// Modified too recently for the time to tell edits apart
+	};
+
+	void Run();
+
+	std::mutex				lock;
+	std::condition_variable wake;
+	std::thread				thread;
+	bool					running	   = false;
+	std::uint32_t			intervalMs = 1000;
+	Callback				callback;
+	std::vector<Entry>		entries;
+};
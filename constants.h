@@ -5,3 +5,5 @@ const enum g_ReleaseTypes { Devel, Testing, Candidate, Release };
 const char*			 g_pluginName	 = "BestInClass++";
 const UInt32		 g_pluginVersion = 0x01010000;
 const g_ReleaseTypes g_pluginRelease = Release;
+
+const char* g_configPath = "Data\\SKSE\\Plugins\\BestInClassPP.ini";
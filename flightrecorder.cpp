@@ -0,0 +1,202 @@
+#include "flightrecorder.h"
+
+#include <cstring>
+
+#include "format.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static_assert(sizeof(FlightRecorder::Record) == 32, "FlightRecorder::Record should stay at 32 bytes");
+
+/*
+DumpWriter
+Collects the text of a dump in the buffer it is given and writes it out whenever the next line
+might not fit, straight through the system calls. Nothing allocates, locks or depends on the
+C runtime's state, which the crash filter cannot trust
+*/
+class DumpWriter
+{
+	public:
+	DumpWriter(char* buffer, std::size_t size) : buffer(buffer), size(size) {}
+
+	bool Open(const char* path)
+	{
+#ifdef _WIN32
+		file = CreateFileA(path, GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+		return file != INVALID_HANDLE_VALUE;
+#else
+		file = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		return file != -1;
+#endif
+	}
+
+	template<class Format, class... Args>
+	void Print(Format format, const Args&... args)
+	{
+		if(size - used < maxLineLength) { Flush(); }
+		used += FormatText(buffer + used, size - used, format, args...);
+	}
+
+	// True when every line made it to the file
+	bool Close()
+	{
+		Flush();
+#ifdef _WIN32
+		CloseHandle(file);
+#else
+		close(file);
+#endif
+		return !failed;
+	}
+
+	private:
+	// Longer than any line of a dump, a score printed as a float has at most 39 digits
+	static const std::size_t maxLineLength = 256;
+
+	void Flush()
+	{
+		for(std::size_t written = 0; written < used && !failed;) {
+#ifdef _WIN32
+			DWORD chunk = 0;
+			failed		= !WriteFile(file, buffer + written, static_cast<DWORD>(used - written), &chunk, nullptr);
+#else
+			ssize_t chunk = write(file, buffer + written, used - written);
+			failed		  = chunk <= 0;
+#endif
+			if(!failed) { written += chunk; }
+		}
+		used = 0;
+	}
+
+#ifdef _WIN32
+	HANDLE file = INVALID_HANDLE_VALUE;
+#else
+	int file = -1;
+#endif
+	char*		buffer;
+	std::size_t size;
+	std::size_t used   = 0;
+	bool		failed = false;
+};
+
+FlightRecorder* FlightRecorder::GetSingleton()
+{
+	static FlightRecorder instance;
+	return &instance;
+}
+
+FlightRecorder::~FlightRecorder()
+{
+	std::string error;
+	if(IsEnabled()) { Dump("shutdown", error); }
+}
+
+void FlightRecorder::Configure(bool enable, const std::string& path)
+{
+	{
+		std::lock_guard<std::mutex> guard(dumpLock);
+		dumpPath = path;
+		FormatText(crashPath, maxPathLength, BIC_FMT("%s"), path.c_str());
+	}
+	enabled.store(enable);
+}
+
+const char* FlightRecorder::GetEventName(std::uint16_t event)
+{
+	static const char* names[kTrace_Count] = {"PassBegin", "PassEnd", "BestItem", "Upgrade", "LoadoutPiece", "AlchemyPart", "SlowPass", "ShadowMismatch", "ItemAdded", "ItemRemoved", "Equipped", "Unequipped", "ConfigPublished", "ItemRanked"};
+	return event < kTrace_Count ? names[event] : "Unknown";
+}
+
+bool FlightRecorder::Dump(const char* reason, std::string& error)
+{
+	std::string path;
+	{
+		std::lock_guard<std::mutex> guard(dumpLock);
+		path = dumpPath;
+	}
+	return Dump(path.c_str(), reason, error);
+}
+
+bool FlightRecorder::Dump(const char* path, const char* reason, std::string& error)
+{
+	std::lock_guard<std::mutex> guard(dumpLock);
+
+	if(!WriteDump(path, reason, dumpBuffer)) {
+		error = std::string("could not write \"") + path + "\"";
+		return false;
+	}
+	return true;
+}
+
+void FlightRecorder::DumpOnCrash()
+{
+	if(!IsEnabled() || crashDumped.exchange(true)) { return; }
+	WriteDump(crashPath, "crash", crashBuffer);
+}
+
+bool FlightRecorder::WriteDump(const char* path, const char* reason, char* buffer)
+{
+	DumpWriter file(buffer, bufferSize);
+	if(!file.Open(path)) { return false; }
+
+	std::uint32_t end	= next.load(std::memory_order_acquire);
+	std::uint32_t begin = end > capacity ? end - capacity : 0;
+
+	// Times are relative to the oldest event still in the ring
+	std::int64_t origin = 0;
+	bool		 first	= true;
+	std::size_t	 count	= 0;
+
+	file.Print(BIC_FMT("# BestInClassPP flight recorder, dumped on %s\n"), reason);
+	file.Print(BIC_FMT("# milliseconds event formID category score\n"));
+
+	for(std::uint32_t index = begin; index != end; index++) {
+		const Record& slot = records[index & (capacity - 1)];
+
+		// A slot rewritten while it was copied has a different sequence afterwards
+		std::uint32_t sequence = slot.sequence.load(std::memory_order_acquire);
+		Record		  copy;
+		copy.event	   = slot.event;
+		copy.timestamp = slot.timestamp;
+		copy.formID	   = slot.formID;
+		copy.category  = slot.category;
+		copy.score	   = slot.score;
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if(sequence != index + 1 || slot.sequence.load(std::memory_order_relaxed) != sequence) { continue; }
+
+		if(first) {
+			origin = copy.timestamp;
+			first  = false;
+		}
+
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::duration(copy.timestamp - origin)).count();
+		file.Print(BIC_FMT("%.3f %s %08x %d %.2f\n"), ms, GetEventName(copy.event), copy.formID, copy.category, copy.score);
+		count++;
+	}
+
+	file.Print(BIC_FMT("# %u events\n"), count);
+	return file.Close();
+}
+
+#ifdef _WIN32
+static LPTOP_LEVEL_EXCEPTION_FILTER g_previousFilter = nullptr;
+
+static LONG WINAPI DumpOnCrash(EXCEPTION_POINTERS* info)
+{
+	// Only the recorder is dumped, flushing the log would take locks and allocate
+	FlightRecorder::GetSingleton()->DumpOnCrash();
+	return g_previousFilter ? g_previousFilter(info) : EXCEPTION_CONTINUE_SEARCH;
+}
+#endif
+
+void InstallCrashDump()
+{
+#ifdef _WIN32
+	g_previousFilter = SetUnhandledExceptionFilter(DumpOnCrash);
+#endif
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+enum TraceEvent : std::uint16_t
+{
+	kTrace_PassBegin,	   // category holds the ItemListFlags, score the number of items
+	kTrace_PassEnd,		   // score holds the milliseconds the pass took
+	kTrace_BestItem,
+	kTrace_Upgrade,
+	kTrace_LoadoutPiece,   // score holds the armor rating of the whole loadout
+	kTrace_AlchemyPart,	   // score holds the strength of the potion
+	kTrace_SlowPass,	   // score holds the milliseconds the pass took
+	kTrace_ShadowMismatch,
+	kTrace_ItemAdded,	   // score holds the count
+	kTrace_ItemRemoved,	   // score holds the count
+	kTrace_Equipped,
+	kTrace_Unequipped,
+	kTrace_ConfigPublished, // category holds the generation
+	kTrace_ItemRanked,
+	kTrace_Count
+};
+
+/*
+FlightRecorder
+Keeps the last capacity trace events in memory as fixed size binary records. Recording is an
+atomic increment and a few stores, nothing is formatted or written until the ring is dumped:
+on demand, when the plugin unloads, after a slow pass or on a crash. Any thread may record.
+Each slot carries the number of the event in it, a dump skips slots that are being rewritten.
+A dump is formatted into a fixed buffer and written whenever it fills, the crash dump has a
+buffer and a copy of the path of its own so it neither locks nor allocates
+*/
+class FlightRecorder
+{
+	public:
+	static const std::uint32_t capacity = 32768;
+
+	struct Record
+	{
+		std::atomic<std::uint32_t> sequence; // Event number + 1, 0 while being written
+		std::uint16_t			   event;
+		std::uint16_t			   pad;
+		std::int64_t			   timestamp;
+		std::uint32_t			   formID;
+		std::int32_t			   category;
+		float					   score;
+	};
+
+	static FlightRecorder* GetSingleton();
+
+	~FlightRecorder();
+
+	// Takes effect for the next event, the shutdown dump goes to dumpPath
+	void Configure(bool enabled, const std::string& dumpPath);
+	bool IsEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+	void Trace(TraceEvent event, std::uint32_t formID = 0, std::int32_t category = -1, float score = 0.0f)
+	{
+		if(!enabled.load(std::memory_order_relaxed)) { return; }
+
+		std::uint32_t index = next.fetch_add(1, std::memory_order_relaxed);
+		Record&		  slot	= records[index & (capacity - 1)];
+
+		slot.sequence.store(0, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		slot.event	   = event;
+		slot.timestamp = std::chrono::steady_clock::now().time_since_epoch().count();
+		slot.formID	   = formID;
+		slot.category  = category;
+		slot.score	   = score;
+		slot.sequence.store(index + 1, std::memory_order_release);
+	}
+
+	// Writes the events oldest first as text, reason goes into the header
+	bool Dump(const char* path, const char* reason, std::string& error);
+	bool Dump(const char* reason, std::string& error);
+
+	// Called from the crash filter, only the first crashing thread dumps
+	void DumpOnCrash();
+
+	static const char* GetEventName(std::uint16_t event);
+
+	private:
+	static const std::size_t bufferSize	   = 64 * 1024;
+	static const std::size_t maxPathLength = 260;
+
+	FlightRecorder() = default;
+
+	bool WriteDump(const char* path, const char* reason, char* buffer);
+
+	std::atomic<bool>		   enabled{false};
+	std::atomic<std::uint32_t> next{0};
+	Record					   records[capacity];
+
+	std::mutex	dumpLock;
+	std::string dumpPath;
+	char		dumpBuffer[bufferSize];
+
+	// A crash while the path is configured may find it half written, the dump then fails
+	std::atomic<bool> crashDumped{false};
+	char			  crashPath[maxPathLength] = {};
+	char			  crashBuffer[bufferSize];
+};
+
+// Dumps the flight recorder when the game crashes, before passing the crash on
+void InstallCrashDump();
@@ -0,0 +1,344 @@
+#include "format.h"
+
+#include <cstring>
+
+// Appends to the buffer and counts what did not fit, so the terminator always has room
+struct FormatOutput
+{
+	char*		buffer;
+	std::size_t size;
+	std::size_t length;
+
+	void Put(char c)
+	{
+		if(length + 1 < size) { buffer[length++] = c; }
+	}
+
+	void Put(const char* text, std::size_t count)
+	{
+		std::size_t room = size > length ? size - length - 1 : 0;
+		if(count > room) { count = room; }
+		std::memcpy(buffer + length, text, count);
+		length += count;
+	}
+
+	void Fill(char c, std::size_t count)
+	{
+		for(std::size_t i = 0; i < count; i++) Put(c);
+	}
+};
+
+struct FormatSpec
+{
+	bool		zeroPad	  = false;
+	bool		leftAlign = false;
+	std::size_t width	  = 0;
+	int			precision = -1;
+	char		conversion;
+};
+
+// Writes the digits of value right to left ending at end, returns where they start
+static char* WriteDecimal(char* end, std::uint64_t value)
+{
+	do {
+		*--end = static_cast<char>('0' + value % 10);
+		value /= 10;
+	} while(value);
+	return end;
+}
+
+static char* WriteHex(char* end, std::uint64_t value, bool upper)
+{
+	const char* digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+	do {
+		*--end = digits[value & 15];
+		value >>= 4;
+	} while(value);
+	return end;
+}
+
+/*
+BigNumber
+Just enough of an unsigned big integer to print a double exactly. The largest double times
+10^9 has 1054 bits
+*/
+struct BigNumber
+{
+	static const std::uint32_t maxLimbs = 34;
+
+	std::uint32_t limbs[maxLimbs];
+	std::uint32_t numLimbs;
+
+	explicit BigNumber(std::uint64_t value) : numLimbs(0)
+	{
+		for(; value; value >>= 32) limbs[numLimbs++] = static_cast<std::uint32_t>(value);
+	}
+
+	void Multiply(std::uint32_t factor)
+	{
+		std::uint64_t carry = 0;
+		for(std::uint32_t i = 0; i < numLimbs; i++) {
+			carry += static_cast<std::uint64_t>(limbs[i]) * factor;
+			limbs[i] = static_cast<std::uint32_t>(carry);
+			carry >>= 32;
+		}
+		if(carry) { limbs[numLimbs++] = static_cast<std::uint32_t>(carry); }
+	}
+
+	void ShiftLeft(std::uint32_t bits)
+	{
+		std::uint32_t words = bits / 32;
+		bits %= 32;
+
+		if(bits) {
+			limbs[numLimbs] = 0;
+			for(std::uint32_t i = numLimbs; i > 0; i--) limbs[i] = (limbs[i] << bits) | (limbs[i - 1] >> (32 - bits));
+			limbs[0] <<= bits;
+			numLimbs++;
+		}
+
+		std::memmove(limbs + words, limbs, numLimbs * sizeof(std::uint32_t));
+		std::memset(limbs, 0, words * sizeof(std::uint32_t));
+		numLimbs += words;
+		Trim();
+	}
+
+	// Shifts right and rounds what was shifted out to the nearest, ties to even
+	void ShiftRightRounded(std::uint32_t bits)
+	{
+		if(bits > numLimbs * 32) {
+			numLimbs = 0;
+			return;
+		}
+
+		// Whether the part shifted out is a half, more or less than that
+		std::uint32_t halfBit = bits - 1;
+		bool		  half	  = GetBit(halfBit);
+		bool		  sticky  = (limbs[halfBit / 32] & ((1u << (halfBit % 32)) - 1)) != 0;
+		for(std::uint32_t i = 0; i < halfBit / 32 && !sticky; i++) sticky = limbs[i] != 0;
+
+		std::uint32_t words = bits / 32;
+		bits %= 32;
+		for(std::uint32_t i = 0; i + words < numLimbs; i++) {
+			std::uint64_t pair = limbs[i + words] | (i + words + 1 < numLimbs ? static_cast<std::uint64_t>(limbs[i + words + 1]) << 32 : 0);
+			limbs[i]		   = static_cast<std::uint32_t>(pair >> bits);
+		}
+		numLimbs -= words;
+		Trim();
+
+		if(half && (sticky || (numLimbs && (limbs[0] & 1)))) { Add(1); }
+	}
+
+	void Add(std::uint32_t value)
+	{
+		std::uint64_t carry = value;
+		for(std::uint32_t i = 0; i < numLimbs && carry; i++) {
+			carry += limbs[i];
+			limbs[i] = static_cast<std::uint32_t>(carry);
+			carry >>= 32;
+		}
+		if(carry) { limbs[numLimbs++] = static_cast<std::uint32_t>(carry); }
+	}
+
+	bool GetBit(std::uint32_t bit) const { return bit / 32 < numLimbs && ((limbs[bit / 32] >> (bit % 32)) & 1); }
+
+	// Returns the remainder
+	std::uint32_t Divide(std::uint32_t divisor)
+	{
+		std::uint64_t remainder = 0;
+		for(std::uint32_t i = numLimbs; i-- > 0;) {
+			remainder = (remainder << 32) | limbs[i];
+			limbs[i]  = static_cast<std::uint32_t>(remainder / divisor);
+			remainder %= divisor;
+		}
+		Trim();
+		return static_cast<std::uint32_t>(remainder);
+	}
+
+	void Trim()
+	{
+		while(numLimbs && !limbs[numLimbs - 1]) numLimbs--;
+	}
+};
+
+// Puts the point into the digits of value * 10^precision between start and end
+static char* WriteFixedDigits(char* end, char* start, int precision)
+{
+	// At least one digit before the point
+	while(end - start < precision + 1) *--start = '0';
+	if(precision) {
+		start--;
+		std::memmove(start, start + 1, (end - start) - precision - 1);
+		end[-precision - 1] = '.';
+	}
+	return start;
+}
+
+// Writes |value| with precision digits after the point, right to left ending at end
+static char* WriteFixed(char* end, double value, int precision)
+{
+	std::uint64_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+
+	std::uint64_t mantissa = bits & ((1ull << 52) - 1);
+	int			  exponent = static_cast<int>((bits >> 52) & 0x7FF);
+	if(exponent == 0x7FF) {
+		const char* text = mantissa ? "nan" : "inf";
+		end -= 3;
+		std::memcpy(end, text, 3);
+		return end;
+	}
+
+	if(exponent) {
+		mantissa |= 1ull << 52;
+	} else {
+		exponent = 1;
+	}
+	exponent -= 1075;
+
+	static const std::uint32_t powers[10] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+
+	// Floats widened to double end in 29 zero bits, without them most values fit 64 bits
+	while(mantissa && !(mantissa & 1) && exponent < 0) {
+		mantissa >>= 1;
+		exponent++;
+	}
+	if(mantissa < (1ull << 34) && exponent <= 0 && exponent > -64) {
+		std::uint64_t scaled = mantissa * powers[precision];
+		std::uint32_t shift	 = static_cast<std::uint32_t>(-exponent);
+		std::uint64_t whole	 = shift ? scaled >> shift : scaled;
+		std::uint64_t rest	 = shift ? scaled & ((1ull << shift) - 1) : 0;
+		std::uint64_t half	 = shift ? 1ull << (shift - 1) : 1;
+		if(shift && (rest > half || (rest == half && (whole & 1)))) { whole++; }
+		return WriteFixedDigits(end, WriteDecimal(end, whole), precision);
+	}
+
+	// value * 10^precision as an integer, rounded
+	BigNumber number(mantissa);
+	number.Multiply(powers[precision]);
+	if(exponent >= 0) {
+		number.ShiftLeft(static_cast<std::uint32_t>(exponent));
+	} else {
+		number.ShiftRightRounded(static_cast<std::uint32_t>(-exponent));
+	}
+
+	// Nine digits per division, the last chunk without leading zeroes
+	char* start = end;
+	while(number.numLimbs) {
+		std::uint32_t chunk	 = number.Divide(powers[9]);
+		char*		  digits = WriteDecimal(start, chunk);
+		if(number.numLimbs) {
+			while(digits > start - 9) *--digits = '0';
+		}
+		start = digits;
+	}
+	return WriteFixedDigits(end, start, precision);
+}
+
+static void WriteField(FormatOutput& output, const FormatSpec& spec, char sign, const char* text, std::size_t length)
+{
+	std::size_t total	= length + (sign ? 1 : 0);
+	std::size_t padding = spec.width > total ? spec.width - total : 0;
+
+	if(!spec.leftAlign && !spec.zeroPad) { output.Fill(' ', padding); }
+	if(sign) { output.Put(sign); }
+	if(!spec.leftAlign && spec.zeroPad) { output.Fill('0', padding); }
+	output.Put(text, length);
+	if(spec.leftAlign) { output.Fill(' ', padding); }
+}
+
+// Negative values printed as unsigned wrap around at their own size, types smaller than int
+// are widened to int first like printf's arguments are
+static std::uint64_t GetUnsigned(const FormatValue& value)
+{
+	std::size_t size = value.size < sizeof(int) ? sizeof(int) : value.size;
+	if(!value.isSigned || size == 8) { return value.u; }
+	return value.u & ((1ull << (size * 8)) - 1);
+}
+
+std::size_t FormatValues(char* buffer, std::size_t size, const char* format, const FormatValue* values)
+{
+	FormatOutput output = {buffer, size, 0};
+
+	// Big enough for the digits of the largest double
+	char  scratch[352];
+	char* scratchEnd = scratch + sizeof(scratch);
+
+	for(const char* p = format; *p; p++) {
+		if(*p != '%') {
+			const char* literal = p;
+			while(p[1] && p[1] != '%') p++;
+			output.Put(literal, p - literal + 1);
+			continue;
+		}
+		if(p[1] == '%') {
+			output.Put('%');
+			p++;
+			continue;
+		}
+
+		// The format was checked while compiling, every conversion has its matching value
+		FormatSpec spec;
+		for(p++; *p == '0' || *p == '-'; p++) {
+			if(*p == '0') { spec.zeroPad = true; }
+			if(*p == '-') { spec.leftAlign = true; }
+		}
+		for(; *p >= '0' && *p <= '9'; p++) spec.width = spec.width * 10 + (*p - '0');
+		if(*p == '.') {
+			spec.precision = p[1] - '0';
+			p += 2;
+		}
+
+		// The value knows its own size
+		while(*p == 'l' || *p == 'h' || *p == 'z') p++;
+		spec.conversion = *p;
+
+		const FormatValue& value = *values++;
+		char			   sign	 = 0;
+		char*			   start = scratchEnd;
+
+		switch(spec.conversion) {
+		case 'd':
+		case 'i':
+			if(value.isSigned && value.i < 0) {
+				sign  = '-';
+				start = WriteDecimal(scratchEnd, 0 - value.u);
+			} else {
+				start = WriteDecimal(scratchEnd, value.u);
+			}
+			break;
+		case 'u': start = WriteDecimal(scratchEnd, GetUnsigned(value)); break;
+		case 'x':
+		case 'X': start = WriteHex(scratchEnd, GetUnsigned(value), spec.conversion == 'X'); break;
+		case 'p':
+			// Every digit of the address, the way MSVC prints it
+			start = WriteHex(scratchEnd, reinterpret_cast<std::uintptr_t>(value.p), true);
+			while(start > scratchEnd - 2 * sizeof(void*)) *--start = '0';
+			break;
+		case 'f': {
+			std::uint64_t bits;
+			std::memcpy(&bits, &value.f, sizeof(bits));
+			if(bits >> 63) { sign = '-'; }
+			start = WriteFixed(scratchEnd, value.f, spec.precision == -1 ? 6 : spec.precision);
+
+			// Infinity and NaN are never zero padded
+			if(*start == 'i' || *start == 'n') { spec.zeroPad = false; }
+			break;
+		}
+		case 's': {
+			const char* text = value.s ? value.s : "(null)";
+			WriteField(output, spec, 0, text, std::strlen(text));
+			continue;
+		}
+		case 'c':
+			start  = scratchEnd - 1;
+			*start = value.c;
+			break;
+		}
+
+		WriteField(output, spec, sign, start, scratchEnd - start);
+	}
+
+	if(size) { buffer[output.length] = 0; }
+	return output.length;
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+/*
+Format
+A printf replacement whose format strings are checked while compiling. The format goes
+through BIC_FMT, which turns the literal into a type, so the function it is passed to can
+static_assert that every conversion matches its argument:
+
+	proc->LogMessage(BIC_FMT("%s has %d items weighing %.1f"), name, count, weight);
+
+Supported are %d %i %u %x %X %f %s %c %p and %%, the flags 0 and -, a width and for %f a
+precision of at most 9 digits. Length modifiers like ll are accepted and ignored, integers of
+any size print with their own value and sign. %f takes float and double, %s const char* and
+%p any pointer. Everything else, %d with a float or %X with a pointer, does not compile.
+
+Nothing depends on the locale and nothing is parsed at runtime besides walking the format
+once. Output equals the C library's for valid calls, %p prints like MSVC does, zero padded
+upper case hex without a prefix. Floats are rounded exactly, ties go to the even digit
+*/
+
+enum FormatArg : char
+{
+	kFormatArg_End,
+	kFormatArg_Integer,
+	kFormatArg_Float,
+	kFormatArg_String,
+	kFormatArg_Char,
+	kFormatArg_Pointer,
+	kFormatArg_Other
+};
+
+template<class T>
+struct FormatArgKind
+{
+	typedef typename std::decay<T>::type Type;
+
+	static const bool isString	= std::is_same<Type, const char*>::value || std::is_same<Type, char*>::value;
+	static const bool isPointer = std::is_pointer<Type>::value || std::is_same<Type, std::nullptr_t>::value;
+
+	static const FormatArg value = std::is_same<Type, char>::value ? kFormatArg_Char
+								 : std::is_integral<Type>::value || std::is_enum<Type>::value ? kFormatArg_Integer
+								 : std::is_floating_point<Type>::value ? kFormatArg_Float
+								 : isString ? kFormatArg_String
+								 : isPointer ? kFormatArg_Pointer
+								 : kFormatArg_Other;
+};
+
+template<class... Args>
+struct FormatArgKinds
+{
+	static constexpr FormatArg values[sizeof...(Args) + 1] = {FormatArgKind<Args>::value..., kFormatArg_End};
+};
+
+template<class... Args>
+constexpr FormatArg FormatArgKinds<Args...>::values[sizeof...(Args) + 1];
+
+// Single return constexpr functions, so the check also compiles with Visual Studio 2015
+namespace FormatCheck
+{
+	constexpr bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+	constexpr const char* SkipFlags(const char* p) { return *p == '0' || *p == '-' ? SkipFlags(p + 1) : p; }
+	constexpr const char* SkipDigits(const char* p) { return IsDigit(*p) ? SkipDigits(p + 1) : p; }
+
+	// -1 without a precision, -2 for one that is not a single digit
+	constexpr int GetPrecision(const char* p) { return *p != '.' ? -1 : IsDigit(p[1]) && !IsDigit(p[2]) ? p[1] - '0' : -2; }
+	constexpr const char* SkipPrecision(const char* p) { return *p == '.' ? SkipDigits(p + 1) : p; }
+	constexpr const char* SkipLength(const char* p) { return *p == 'l' || *p == 'h' || *p == 'z' ? SkipLength(p + 1) : p; }
+
+	constexpr bool Accepts(char conversion, FormatArg arg, bool precision)
+	{
+		return conversion == 'f' ? arg == kFormatArg_Float
+			 : precision ? false
+			 : conversion == 'd' || conversion == 'i' || conversion == 'u' || conversion == 'x' || conversion == 'X' ? arg == kFormatArg_Integer
+			 : conversion == 's' ? arg == kFormatArg_String
+			 : conversion == 'c' ? arg == kFormatArg_Char
+			 : conversion == 'p' ? arg == kFormatArg_Pointer || arg == kFormatArg_String
+			 : false;
+	}
+
+	constexpr bool Check(const char* p, const FormatArg* args);
+
+	constexpr bool CheckConversion(const char* conversion, int precision, const FormatArg* args) { return precision != -2 && *args != kFormatArg_End && Accepts(*conversion, *args, precision != -1) && Check(conversion + 1, args + 1); }
+
+	// Every argument is used by exactly one conversion
+	constexpr bool Check(const char* p, const FormatArg* args)
+	{
+		return !*p ? *args == kFormatArg_End
+			 : *p != '%' ? Check(p + 1, args)
+			 : p[1] == '%' ? Check(p + 2, args)
+			 : CheckConversion(SkipLength(SkipPrecision(SkipDigits(SkipFlags(p + 1)))), GetPrecision(SkipDigits(SkipFlags(p + 1))), args);
+	}
+}
+
+#define BIC_FMT(text) \
+	[] { \
+		struct Format \
+		{ \
+			static constexpr const char* Get() { return text; } \
+		}; \
+		return Format(); \
+	}()
+
+#define BIC_CHECK_FORMAT(Format, Args) static_assert(FormatCheck::Check(Format::Get(), FormatArgKinds<Args...>::values), "The format string does not match its arguments")
+
+// One argument with its type erased, the formatting itself is not a template
+struct FormatValue
+{
+	FormatArg	 kind	  = kFormatArg_End;
+	bool		 isSigned = false;
+	std::uint8_t size	  = 0;
+	union
+	{
+		std::int64_t  i;
+		std::uint64_t u;
+		double		  f;
+		const char*	  s;
+		const void*	  p;
+		char		  c;
+	};
+
+	FormatValue() : u(0) {}
+	FormatValue(char value) : kind(kFormatArg_Char), c(value) {}
+	FormatValue(bool value) : kind(kFormatArg_Integer), size(1), u(value) {}
+	FormatValue(float value) : kind(kFormatArg_Float), f(value) {}
+	FormatValue(double value) : kind(kFormatArg_Float), f(value) {}
+	FormatValue(const char* value) : kind(kFormatArg_String), s(value) {}
+	FormatValue(char* value) : kind(kFormatArg_String), s(value) {}
+	FormatValue(std::nullptr_t) : kind(kFormatArg_Pointer), p(nullptr) {}
+
+	template<class T>
+	FormatValue(T* value) : kind(kFormatArg_Pointer), p(value)
+	{
+	}
+
+	template<class T, typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value, int>::type = 0>
+	FormatValue(T value) : kind(kFormatArg_Integer), isSigned(true), size(sizeof(T)), i(value)
+	{
+	}
+
+	template<class T, typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value, int>::type = 0>
+	FormatValue(T value) : kind(kFormatArg_Integer), size(sizeof(T)), u(value)
+	{
+	}
+
+	template<class T, typename std::enable_if<std::is_enum<T>::value, int>::type = 0>
+	FormatValue(T value) : FormatValue(static_cast<typename std::underlying_type<T>::type>(value))
+	{
+	}
+};
+
+// Writes at most size - 1 characters and a terminator, returns the number written. Output that
+// does not fit is cut off
+std::size_t FormatValues(char* buffer, std::size_t size, const char* format, const FormatValue* values);
+
+template<class... Args>
+std::size_t FormatTo(char* buffer, std::size_t size, const char* format, const Args&... args)
+{
+	const FormatValue values[sizeof...(Args) + 1] = {FormatValue(args)...};
+	return FormatValues(buffer, size, format, values);
+}
+
+template<class Format, class... Args>
+std::size_t FormatText(char* buffer, std::size_t size, Format, const Args&... args)
+{
+	BIC_CHECK_FORMAT(Format, Args);
+	return FormatTo(buffer, size, Format::Get(), args...);
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <SKSE.h>
+
+#include <SKSE/GameForms.h>
+#include <SKSE/GameObjects.h>
+#include <SKSE/GameRTTI.h>
+
+#include <cassert>
+
+/*
+Form Dispatch
+The form type byte already says which class a form is, so the per-item loop downcasts with
+a static_cast instead of walking the RTTI through DYNAMIC_CAST. Debug builds still run the
+RTTI cast and assert that both agree
+*/
+template<class T>
+struct FormTypeOf;
+
+template<>
+struct FormTypeOf<TESObjectWEAP>
+{
+	static const UInt8 value = kFormType_Weapon;
+};
+
+template<>
+struct FormTypeOf<TESObjectARMO>
+{
+	static const UInt8 value = kFormType_Armor;
+};
+
+template<>
+struct FormTypeOf<TESAmmo>
+{
+	static const UInt8 value = kFormType_Ammo;
+};
+
+template<>
+struct FormTypeOf<AlchemyItem>
+{
+	static const UInt8 value = kFormType_Potion;
+};
+
+template<class T>
+inline T* FormCast(TESForm* form)
+{
+	if(!form || form->formType != FormTypeOf<T>::value) { return nullptr; }
+
+	T* result = static_cast<T*>(form);
+	assert(result == DYNAMIC_CAST<T*>(form));
+	return result;
+}
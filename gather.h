@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <xmmintrin.h>
+
+inline void Prefetch(const void* address)
+{
+	_mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+}
+
+/*
+GatherRecords
+On a cold inventory every level of the pointer chain is a cache miss, and each one depends on
+the previous. Each level is prefetched a distance further ahead than the level it is read
+through, so when an item is reached its item data, entry data and base form are already in
+the cache. A distance of 0 turns prefetching off.
+Items are reached as items[i]->objDesc->baseForm and records built as {baseForm, i, -1, 0},
+so the same loop runs over the game's lists and the synthetic ones of tools/gatherbench
+*/
+template<class ItemArray, class Record>
+inline std::uint32_t GatherRecords(ItemArray& items, Record* records, std::uint32_t distance)
+{
+	std::uint32_t count		 = items.size();
+	std::uint32_t numRecords = 0;
+
+	for(std::uint32_t i = 0; i < count; i++) {
+		if(distance) {
+			if(i + 3 * distance < count) { Prefetch(items[i + 3 * distance]); }
+			if(i + 2 * distance < count) { Prefetch(items[i + 2 * distance]->objDesc); }
+			if(i + distance < count) { Prefetch(items[i + distance]->objDesc->baseForm); }
+		}
+
+		auto baseForm = items[i]->objDesc->baseForm;
+		if(baseForm) { records[numRecords++] = {baseForm, i, -1, 0.0f}; }
+	}
+	return numRecords;
+}
@@ -2,32 +2,19 @@
 
 void Hook_MarkBestInClass()
 {
-	Plugin_BestInClassPP_Proc proc;
+	// Kept across calls so its scratch arena is reused
+	static Plugin_BestInClassPP_Proc proc;
 
-	UIStringHolder* holder = UIStringHolder::GetSingleton();
-	MenuManager*	mm	   = MenuManager::GetSingleton();
+	const MenuRegistry::Entry* entry = MenuRegistry::GetSingleton()->FindOpen(MenuManager::GetSingleton());
 
-	if(mm->IsMenuOpen(holder->inventoryMenu)) {
-		IMenu*						 menu		   = mm->GetMenu(holder->inventoryMenu);
-		InventoryMenu*				 invMenu	   = dynamic_cast<InventoryMenu*>(menu);
-		BSTArray<StandardItemData*>& itemDataArray = invMenu->inventoryData->items;
+	if(entry) {
+		IMenu* menu = MenuManager::GetSingleton()->GetMenu(*entry->name);
 
-		proc.LogMessage("HOOK: InventoryMenu is at address %08X", invMenu);
-		proc.ProcessInventory(itemDataArray);
-	} else if(mm->IsMenuOpen(holder->barterMenu)) {
-		IMenu*						 menu		   = mm->GetMenu(holder->barterMenu);
-		BarterMenu*					 barMenu	   = dynamic_cast<BarterMenu*>(menu);
-		BSTArray<StandardItemData*>& itemDataArray = barMenu->barterInventoryData->items;
-
-		proc.LogMessage("HOOK: BarterMenu is at address %08X", barMenu);
-		proc.ProcessInventory(itemDataArray);
-	} else if(mm->IsMenuOpen(holder->containerMenu)) {
-		IMenu*						 menu		   = mm->GetMenu(holder->containerMenu);
-		ContainerMenu*				 conMenu	   = dynamic_cast<ContainerMenu*>(menu);
-		BSTArray<StandardItemData*>& itemDataArray = conMenu->inventoryData->items;
-
-		proc.LogMessage("HOOK: ContainerMenu is at address %08X", conMenu);
-		proc.ProcessInventory(itemDataArray);
+		// The game calls this right after filling the list, so the hook always ranks
+		if(menu) {
+			proc.LogMessage(BIC_FMT("HOOK: %s is at address %p"), entry->label, menu);
+			proc.ProcessInventory(*entry->accessor(menu), entry->listFlags, entry->label);
+		}
 	}
 
 	return;
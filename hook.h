@@ -3,6 +3,7 @@
 #include "SKSE/HookUtil.h"
 #include "Skyrim.h"
 
+#include "menus.h"
 #include "processor.h"
 
 void InstallHook();
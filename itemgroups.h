@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "arena.h"
+
+/*
+ItemGroups
+Loot duplicates and stacks split by extra data share one base form. The facts a rule sees are
+read from the base form alone, so every item of a form lands in the same category with the
+same score. The table keeps that result per form and a pass classifies each form only once.
+Extra data that scoring reads has to become part of the key, entries enchanted by the player
+use the entry itself. The same goes for tempering should scoring ever read it.
+Open addressing over a power of two table taken from the pass arena
+*/
+class ItemGroups
+{
+	public:
+	struct Group
+	{
+		const void* form;
+		int			category;
+		float		score;
+	};
+
+	ItemGroups(Arena& arena, std::size_t maxForms)
+	{
+		std::size_t capacity = 16;
+		while(capacity < maxForms * 2) { capacity <<= 1; }
+
+		slots = arena.AllocateArray<Group>(capacity);
+		mask  = capacity - 1;
+		for(std::size_t i = 0; i < capacity; i++) { slots[i].form = nullptr; }
+	}
+
+	// Returns the group of the form, added is set when the group is new and its result not yet filled in
+	Group& Find(const void* form, bool& added)
+	{
+		std::size_t index = Hash(form) & mask;
+		while(slots[index].form && slots[index].form != form) { index = (index + 1) & mask; }
+
+		Group& group = slots[index];
+		added		 = !group.form;
+		if(added) {
+			group.form	   = form;
+			group.category = -1;
+			group.score	   = 0.0f;
+			numGroups++;
+		}
+		return group;
+	}
+
+	std::size_t GetNumGroups() const { return numGroups; }
+
+	private:
+	static std::size_t Hash(const void* form)
+	{
+		// Forms are heap objects, the low bits carry no information
+		std::uint32_t key = static_cast<std::uint32_t>(reinterpret_cast<std::uintptr_t>(form) >> 4);
+		key ^= key >> 16;
+		key *= 0x7FEB352Du;
+		key ^= key >> 15;
+		return key;
+	}
+
+	Group*		slots;
+	std::size_t mask;
+	std::size_t numGroups = 0;
+};
@@ -0,0 +1,106 @@
+#include "keywords.h"
+#include "formdispatch.h"
+
+#include <SKSE.h>
+
+#include <SKSE/GameData.h>
+#include <SKSE/GameForms.h>
+#include <SKSE/GameObjects.h>
+#include <SKSE/GameRTTI.h>
+
+void KeywordIndex::SetKeywords(const std::uint32_t* formIDs, std::uint32_t count)
+{
+	keywordFormIDs.assign(formIDs, formIDs + count);
+	keywordBits.clear();
+	formKeywords.clear();
+}
+
+KeywordSet KeywordIndex::BuildKeywordSet(const BGSKeywordForm* keywordForm) const
+{
+	KeywordSet set;
+
+	if(keywordForm && !keywordBits.empty()) {
+		for(UInt32 i = 0; i < keywordForm->numKeywords; i++) {
+			auto it = keywordBits.find(keywordForm->keywords[i]);
+			if(it != keywordBits.end()) { set.Set(it->second); }
+		}
+	}
+
+	return set;
+}
+
+void KeywordCatalog::AddForm(const TESForm* form, const BGSKeywordForm* keywordForm)
+{
+	Entry entry = {form, static_cast<std::uint32_t>(keywordFormIDs.size()), 0};
+	for(UInt32 i = 0; i < keywordForm->numKeywords; i++) {
+		if(keywordForm->keywords[i]) { keywordFormIDs.push_back(keywordForm->keywords[i]->GetFormID()); }
+	}
+	entry.count = static_cast<std::uint32_t>(keywordFormIDs.size()) - entry.first;
+	forms.push_back(entry);
+}
+
+void KeywordCatalog::Build()
+{
+	keywords.clear();
+	forms.clear();
+	keywordFormIDs.clear();
+
+	DataHandler* dh = DataHandler::GetSingleton();
+
+	for(BGSKeyword* keyword : dh->arrKYWD) {
+		if(keyword) { keywords[keyword] = keyword->GetFormID(); }
+	}
+	for(TESObjectWEAP* objWEAP : dh->arrWEAP) {
+		if(objWEAP) { AddForm(objWEAP, objWEAP); }
+	}
+	for(TESObjectARMO* objARMO : dh->arrARMO) {
+		if(objARMO) { AddForm(objARMO, objARMO); }
+	}
+	for(TESAmmo* tesAMMO : dh->arrAMMO) {
+		if(tesAMMO) { AddForm(tesAMMO, tesAMMO); }
+	}
+}
+
+void KeywordIndex::Resolve(const KeywordCatalog& catalog)
+{
+	keywordBits.clear();
+	formKeywords.clear();
+
+	std::unordered_map<std::uint32_t, std::uint32_t> bits;
+	for(std::uint32_t bit = 0; bit < keywordFormIDs.size(); bit++) bits[keywordFormIDs[bit]] = bit;
+
+	for(const auto& keyword : catalog.keywords) {
+		auto it = bits.find(keyword.second);
+		if(it != bits.end()) { keywordBits[keyword.first] = it->second; }
+	}
+
+	for(const KeywordCatalog::Entry& entry : catalog.forms) {
+		KeywordSet set;
+		if(!keywordBits.empty()) {
+			for(std::uint32_t i = entry.first; i < entry.first + entry.count; i++) {
+				auto it = bits.find(catalog.keywordFormIDs[i]);
+				if(it != bits.end()) { set.Set(it->second); }
+			}
+		}
+		formKeywords[entry.form] = set;
+	}
+}
+
+KeywordSet KeywordIndex::GetKeywords(TESForm* form) const
+{
+	if(keywordBits.empty()) { return KeywordSet(); }
+
+	auto it = formKeywords.find(form);
+	if(it != formKeywords.end()) { return it->second; }
+
+	// Forms created at runtime are not in the DataHandler, their set is built on every lookup
+	const BGSKeywordForm* keywordForm = nullptr;
+	switch(form->formType) {
+		case kFormType_Weapon: keywordForm = FormCast<TESObjectWEAP>(form); break;
+		case kFormType_Armor: keywordForm = FormCast<TESObjectARMO>(form); break;
+		case kFormType_Ammo: keywordForm = FormCast<TESAmmo>(form); break;
+		default: break;
+	}
+
+	return BuildKeywordSet(keywordForm);
+}
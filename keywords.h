@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class BGSKeyword;
+class BGSKeywordForm;
+class TESForm;
+
+/*
+KeywordSet
+A small fixed-width bitset over the dense keyword bits handed out by the KeywordIndex.
+Only keywords referenced by a category rule get a bit, so two words cover every realistic load order.
+*/
+struct KeywordSet
+{
+	static const std::uint32_t numWords = 2;
+	static const std::uint32_t maxBits	= numWords * 64;
+
+	std::uint64_t words[numWords] = {};
+
+	void Set(std::uint32_t bit) { words[bit >> 6] |= 1ull << (bit & 63); }
+	bool Test(std::uint32_t bit) const { return (words[bit >> 6] & (1ull << (bit & 63))) != 0; }
+
+	// (this AND other) == other
+	bool ContainsAll(const KeywordSet& other) const
+	{
+		std::uint64_t missing = 0;
+		for(std::uint32_t i = 0; i < numWords; i++) missing |= other.words[i] & ~words[i];
+		return missing == 0;
+	}
+
+	// (this AND other) != 0
+	bool Intersects(const KeywordSet& other) const
+	{
+		std::uint64_t shared = 0;
+		for(std::uint32_t i = 0; i < numWords; i++) shared |= other.words[i] & words[i];
+		return shared != 0;
+	}
+
+	bool Empty() const
+	{
+		std::uint64_t any = 0;
+		for(std::uint32_t i = 0; i < numWords; i++) any |= words[i];
+		return any == 0;
+	}
+};
+
+/*
+KeywordCatalog
+The keywords of every weapon, armor and ammo form by FormID, copied from the game data once on
+the game thread after data load. Reloads on other threads build their KeywordIndex from it
+without looking up or walking any form
+*/
+class KeywordCatalog
+{
+	public:
+	// Game thread only
+	void Build();
+
+	std::uint32_t GetNumForms() const { return static_cast<std::uint32_t>(forms.size()); }
+
+	private:
+	friend class KeywordIndex;
+
+	struct Entry
+	{
+		const TESForm* form;
+		std::uint32_t  first; // Into keywordFormIDs
+		std::uint32_t  count;
+	};
+
+	void AddForm(const TESForm* form, const BGSKeywordForm* keywordForm);
+
+	std::unordered_map<const BGSKeyword*, std::uint32_t> keywords;
+	std::vector<Entry>									 forms;
+	std::vector<std::uint32_t>							 keywordFormIDs;
+};
+
+/*
+KeywordIndex
+Built alongside the compiled rules and never modified once resolved, so a configuration
+snapshot can share it with the menu thread without locking
+*/
+class KeywordIndex
+{
+	public:
+	// The compiled rules decide which keywords are relevant, bit N belongs to formIDs[N]
+	void SetKeywords(const std::uint32_t* formIDs, std::uint32_t count);
+
+	// Maps the keywords to their forms and builds the per-form bitsets, safe on any thread
+	void Resolve(const KeywordCatalog& catalog);
+
+	KeywordSet GetKeywords(TESForm* form) const;
+
+	std::uint32_t GetNumKeywords() const { return static_cast<std::uint32_t>(keywordFormIDs.size()); }
+	std::uint32_t GetNumForms() const { return static_cast<std::uint32_t>(formKeywords.size()); }
+
+	private:
+	KeywordSet BuildKeywordSet(const BGSKeywordForm* keywordForm) const;
+
+	std::vector<std::uint32_t>						  keywordFormIDs;
+	std::unordered_map<const BGSKeyword*, std::uint32_t> keywordBits;
+	std::unordered_map<const TESForm*, KeywordSet>	  formKeywords;
+};
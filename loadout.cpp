@@ -0,0 +1,177 @@
+#include "loadout.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+// Larger budgets are solved at a coarser step
+static const std::uint32_t maxSteps = 4096;
+
+// Every combination of occupied slots
+static const std::uint32_t numMasks = 1u << kLoadout_NumSlots;
+
+static std::uint32_t ToSteps(float weight, float step)
+{
+	// The epsilon keeps weights that are exact multiples of the step from rounding up
+	return static_cast<std::uint32_t>(std::ceil(std::max(0.0f, weight) / step - 1e-4f));
+}
+
+// The budget rounds down, unlike the weights
+static std::uint32_t BudgetSteps(float budget, float step)
+{
+	return static_cast<std::uint32_t>(budget / step + 1e-4f);
+}
+
+static float ClampStep(float budget, float step)
+{
+	return std::max(step, budget / maxSteps);
+}
+
+std::uint32_t SolveLoadout(Arena& arena, const LoadoutItem* items, std::uint32_t count, float budget, float step, std::uint32_t* chosen, float& score)
+{
+	score = 0.0f;
+	if(budget < 0.0f || step <= 0.0f) { return 0; }
+
+	step = ClampStep(budget, step);
+
+	std::uint32_t numSteps = BudgetSteps(budget, step);
+
+	struct Candidate
+	{
+		std::uint32_t item;
+		std::uint32_t slots;
+		std::uint32_t steps;
+		float		  score;
+	};
+
+	// Pieces that can never be worn or add nothing are left out right away
+	Candidate*	  candidates	= arena.AllocateArray<Candidate>(count);
+	std::uint32_t numCandidates = 0;
+	for(std::uint32_t i = 0; i < count; i++) {
+		std::uint32_t steps = ToSteps(items[i].weight, step);
+		if(items[i].slots && items[i].slots < numMasks && items[i].score > 0.0f && steps <= numSteps) { candidates[numCandidates++] = {i, items[i].slots, steps, items[i].score}; }
+	}
+
+	std::sort(candidates, candidates + numCandidates, [](const Candidate& a, const Candidate& b) {
+		if(a.slots != b.slots) { return a.slots < b.slots; }
+		if(a.steps != b.steps) { return a.steps < b.steps; }
+		return a.score > b.score;
+	});
+
+	// Dominance pruning, within a group of pieces covering the same slots a piece survives only
+	// if it beats every lighter one
+	std::uint32_t* groupStart = arena.AllocateArray<std::uint32_t>(numMasks);
+	std::uint32_t  numGroups  = 0;
+	std::uint32_t  numKept	  = 0;
+	for(std::uint32_t i = 0; i < numCandidates;) {
+		std::uint32_t slots = candidates[i].slots;
+		float		  best	= 0.0f;
+
+		groupStart[numGroups++] = numKept;
+		for(; i < numCandidates && candidates[i].slots == slots; i++) {
+			if(candidates[i].score > best) {
+				best				  = candidates[i].score;
+				candidates[numKept++] = candidates[i];
+			}
+		}
+	}
+	groupStart[numGroups] = numKept;
+
+	// best[mask * width + w] is the highest score of a set occupying exactly the slots of mask
+	// with at most w steps of weight, -1 if there is none. choice remembers the piece each group
+	// added to reach it, the slots it came from are mask without the group's
+	std::uint32_t width				= numSteps + 1;
+	float*		  best				= arena.AllocateArray<float>(numMasks * width);
+	float*		  next				= arena.AllocateArray<float>(numMasks * width);
+	std::int32_t* choice			= arena.AllocateArray<std::int32_t>(numGroups * numMasks * width);
+	bool		  reached[numMasks] = {true};
+	std::fill(best, best + numMasks * width, -1.0f);
+	std::fill(next, next + numMasks * width, -1.0f);
+	std::fill(best, best + width, 0.0f);
+
+	for(std::uint32_t g = 0; g < numGroups; g++) {
+		std::uint32_t slots		  = candidates[groupStart[g]].slots;
+		std::int32_t* groupChoice = choice + g * numMasks * width;
+		// Only the rows of sets reached so far hold anything, the others stay -1 in both buffers
+		for(std::uint32_t mask = 0; mask < numMasks; mask++) {
+			if(!reached[mask]) { continue; }
+			std::copy(best + mask * width, best + (mask + 1) * width, next + mask * width);
+			std::fill(groupChoice + mask * width, groupChoice + (mask + 1) * width, -1);
+		}
+
+		// The sets a group reaches all hold its slots, so none of them is a source for it again
+		for(std::uint32_t from = 0; from < numMasks; from++) {
+			if(!reached[from] || (from & slots)) { continue; }
+
+			std::uint32_t to	 = from | slots;
+			const float*  source = best + from * width;
+			float*		  target = next + to * width;
+			std::int32_t* picked = groupChoice + to * width;
+			if(!reached[to]) {
+				std::fill(picked, picked + width, -1);
+				reached[to] = true;
+			}
+
+			for(std::uint32_t w = 0; w < width; w++) {
+				for(std::uint32_t k = groupStart[g]; k < groupStart[g + 1]; k++) {
+					const Candidate& candidate = candidates[k];
+					if(candidate.steps > w) { break; }
+					if(source[w - candidate.steps] < 0.0f) { continue; }
+
+					float total = source[w - candidate.steps] + candidate.score;
+					if(total > target[w]) {
+						target[w] = total;
+						picked[w] = static_cast<std::int32_t>(k);
+					}
+				}
+			}
+		}
+		std::swap(best, next);
+	}
+
+	std::uint32_t mask = 0;
+	for(std::uint32_t m = 1; m < numMasks; m++) {
+		if(best[m * width + numSteps] > best[mask * width + numSteps]) { mask = m; }
+	}
+	score = best[mask * width + numSteps];
+
+	std::uint32_t numChosen = 0;
+	std::uint32_t w			= numSteps;
+	for(std::uint32_t g = numGroups; g-- > 0;) {
+		std::int32_t k = choice[(g * numMasks + mask) * width + w];
+		if(k != -1) {
+			chosen[numChosen++] = items[candidates[k].item].index;
+			mask ^= candidates[k].slots;
+			w -= candidates[k].steps;
+		}
+	}
+
+#ifndef NDEBUG
+	// Small inputs are cheap enough to check against every combination
+	if(count <= 12) {
+		float reference = SolveLoadoutExhaustive(items, count, budget, step);
+		assert(std::fabs(reference - score) <= 1e-3f * std::max(1.0f, reference));
+	}
+#endif
+
+	return numChosen;
+}
+
+// Takes or leaves every piece in turn, a piece is only taken if none of its slots are
+static float SearchLoadout(const LoadoutItem* items, std::uint32_t count, std::uint32_t i, std::uint32_t used, std::uint32_t stepsLeft, float step)
+{
+	if(i == count) { return 0.0f; }
+
+	float		  best	= SearchLoadout(items, count, i + 1, used, stepsLeft, step);
+	std::uint32_t steps = ToSteps(items[i].weight, step);
+	if(items[i].slots && items[i].slots < numMasks && !(items[i].slots & used) && items[i].score > 0.0f && steps <= stepsLeft) { best = std::max(best, items[i].score + SearchLoadout(items, count, i + 1, used | items[i].slots, stepsLeft - steps, step)); }
+	return best;
+}
+
+float SolveLoadoutExhaustive(const LoadoutItem* items, std::uint32_t count, float budget, float step)
+{
+	if(budget < 0.0f || step <= 0.0f) { return 0.0f; }
+
+	step = ClampStep(budget, step);
+	return SearchLoadout(items, count, 0, 0, BudgetSteps(budget, step), step);
+}
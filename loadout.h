@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+
+#include "arena.h"
+
+/*
+Loadout
+The best armor set within a weight budget, no two pieces sharing a slot. A hooded robe covers
+the body and the head, so it rules out a helmet as well as a cuirass. That is a multiple choice
+knapsack over groups of pieces covering the same slots: per group the pieces are sorted by
+weight and every piece that is not better than a lighter one is dropped, the survivors go
+through a DP over the occupied slots and the weight discretized into steps. Weights are rounded
+up to whole steps, so a chosen set never exceeds the budget
+*/
+enum LoadoutSlot : std::uint32_t
+{
+	kLoadout_Body,
+	kLoadout_Feet,
+	kLoadout_Hands,
+	kLoadout_Head,
+	kLoadout_Shield,
+	kLoadout_NumSlots
+};
+
+inline std::uint32_t LoadoutSlotBit(LoadoutSlot slot)
+{
+	return 1u << slot;
+}
+
+struct LoadoutItem
+{
+	std::uint32_t index; // Position of the item in the caller's list
+	std::uint32_t slots; // LoadoutSlotBit of every slot the piece occupies, 0 if it belongs to none
+	float		  weight;
+	float		  score;
+};
+
+// Writes the index of every chosen item to chosen, which holds kLoadout_NumSlots entries, and returns their count
+std::uint32_t SolveLoadout(Arena& arena, const LoadoutItem* items, std::uint32_t count, float budget, float step, std::uint32_t* chosen, float& score);
+
+// Tries every combination, only meant to verify SolveLoadout on small inputs
+float SolveLoadoutExhaustive(const LoadoutItem* items, std::uint32_t count, float budget, float step);
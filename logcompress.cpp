@@ -0,0 +1,215 @@
+#include "logcompress.h"
+
+#include <cstring>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static const std::uint32_t kMinMatch   = 4;
+static const std::uint32_t kMaxOffset  = 65535;
+static const std::uint32_t kHashShift  = 32 - 12;
+static const std::uint32_t kNoPosition = 0xFFFFFFFFu;
+
+static_assert(kCompressTableSize == 1u << (32 - kHashShift), "The hash has to index the whole table");
+
+static std::uint32_t Read32(const std::uint8_t* p)
+{
+	std::uint32_t value;
+	std::memcpy(&value, p, sizeof(value));
+	return value;
+}
+
+static std::uint64_t Read64(const std::uint8_t* p)
+{
+	std::uint64_t value;
+	std::memcpy(&value, p, sizeof(value));
+	return value;
+}
+
+static std::uint32_t LowestBit(std::uint64_t value)
+{
+#ifdef _MSC_VER
+	// Win32 has no 64 bit scan
+	unsigned long index;
+	if(_BitScanForward(&index, static_cast<unsigned long>(value))) { return index; }
+	_BitScanForward(&index, static_cast<unsigned long>(value >> 32));
+	return index + 32;
+#else
+	return static_cast<std::uint32_t>(__builtin_ctzll(value));
+#endif
+}
+
+static std::uint32_t Hash(std::uint32_t value)
+{
+	return (value * 2654435761u) >> kHashShift;
+}
+
+// 15 in the token, then bytes of 255 and the rest
+static std::uint8_t* WriteLength(std::uint8_t* out, std::size_t length)
+{
+	for(; length >= 255; length -= 255) *out++ = 255;
+	*out++ = static_cast<std::uint8_t>(length);
+	return out;
+}
+
+static std::uint8_t* WriteSequence(std::uint8_t* out, const std::uint8_t* literals, std::size_t numLiterals, std::size_t offset, std::size_t matchLength)
+{
+	std::uint8_t* token		 = out++;
+	std::size_t	  matchExtra = matchLength ? matchLength - kMinMatch : 0;
+	*token					 = static_cast<std::uint8_t>((numLiterals < 15 ? numLiterals : 15) << 4);
+	if(numLiterals >= 15) { out = WriteLength(out, numLiterals - 15); }
+
+	std::memcpy(out, literals, numLiterals);
+	out += numLiterals;
+	if(!matchLength) { return out; }
+
+	*out++ = static_cast<std::uint8_t>(offset);
+	*out++ = static_cast<std::uint8_t>(offset >> 8);
+	*token |= static_cast<std::uint8_t>(matchExtra < 15 ? matchExtra : 15);
+	if(matchExtra >= 15) { out = WriteLength(out, matchExtra - 15); }
+	return out;
+}
+
+std::size_t CompressBlock(const std::uint8_t* source, std::size_t size, std::uint8_t* destination, std::size_t capacity, std::uint32_t* table)
+{
+	if(capacity < GetCompressBound(size)) { return 0; }
+
+	for(std::uint32_t i = 0; i < kCompressTableSize; i++) table[i] = kNoPosition;
+
+	std::uint8_t* out	   = destination;
+	std::size_t	  literals = 0;
+	std::size_t	  position = 0;
+
+	// Greedy, every position is looked up until one matches four bytes the table remembers
+	while(position + kMinMatch <= size) {
+		std::uint32_t value	   = Read32(source + position);
+		std::uint32_t hash	   = Hash(value);
+		std::uint32_t previous = table[hash];
+		table[hash]			   = static_cast<std::uint32_t>(position);
+
+		if(previous == kNoPosition || position - previous > kMaxOffset || Read32(source + previous) != value) {
+			position++;
+			continue;
+		}
+
+		// Eight bytes at a time, the first differing byte is the lowest set bit of their xor
+		std::size_t length = kMinMatch;
+		while(position + length + 8 <= size) {
+			std::uint64_t difference = Read64(source + position + length) ^ Read64(source + previous + length);
+			if(difference) {
+				length += LowestBit(difference) / 8;
+				break;
+			}
+			length += 8;
+		}
+		if(position + length + 8 > size) {
+			while(position + length < size && source[previous + length] == source[position + length]) length++;
+		}
+
+		out = WriteSequence(out, source + literals, position - literals, position - previous, length);
+
+		// The positions inside the match are skipped, only its last one is remembered
+		position += length;
+		literals = position;
+		if(position + kMinMatch <= size) { table[Hash(Read32(source + position - 1))] = static_cast<std::uint32_t>(position - 1); }
+	}
+
+	out = WriteSequence(out, source + literals, size - literals, 0, 0);
+	return out - destination;
+}
+
+static bool ReadLength(const std::uint8_t*& in, const std::uint8_t* end, std::size_t& length)
+{
+	std::uint8_t byte;
+	do {
+		if(in == end) { return false; }
+		byte = *in++;
+		length += byte;
+	} while(byte == 255);
+	return true;
+}
+
+bool DecompressBlock(const std::uint8_t* source, std::size_t size, std::uint8_t* destination, std::size_t capacity, std::size_t& written)
+{
+	const std::uint8_t* in	= source;
+	const std::uint8_t* end = source + size;
+	std::uint8_t*		out = destination;
+
+	written = 0;
+	while(in < end) {
+		std::uint8_t token		 = *in++;
+		std::size_t	 numLiterals = token >> 4;
+		if(numLiterals == 15 && !ReadLength(in, end, numLiterals)) { return false; }
+		if(numLiterals > static_cast<std::size_t>(end - in) || numLiterals > capacity - (out - destination)) { return false; }
+
+		std::memcpy(out, in, numLiterals);
+		in += numLiterals;
+		out += numLiterals;
+
+		// Only the last sequence ends after its literals
+		if(in == end) { break; }
+
+		if(end - in < 2) { return false; }
+		std::size_t offset = in[0] | (in[1] << 8);
+		in += 2;
+
+		std::size_t length = token & 15;
+		if(length == 15 && !ReadLength(in, end, length)) { return false; }
+		length += kMinMatch;
+
+		if(!offset || offset > static_cast<std::size_t>(out - destination) || length > capacity - (out - destination)) { return false; }
+
+		// A match overlapping the bytes it produces repeats them, it is copied byte by byte
+		const std::uint8_t* match = out - offset;
+		if(offset >= length) {
+			std::memcpy(out, match, length);
+		} else {
+			for(std::size_t i = 0; i < length; i++) out[i] = match[i];
+		}
+		out += length;
+	}
+
+	written = out - destination;
+	return true;
+}
+
+bool LogCompressor::Add(const char* text, std::size_t length)
+{
+	if(length > blockSize - pending) { return false; }
+
+	std::memcpy(input + pending, text, length);
+	pending += length;
+	return true;
+}
+
+static void Write32(std::uint8_t* p, std::uint32_t value)
+{
+	std::memcpy(p, &value, sizeof(value));
+}
+
+std::size_t LogCompressor::Finish(const std::uint8_t*& frame)
+{
+	if(!pending) { return 0; }
+
+	// Text that does not compress is stored as it is
+	std::size_t size = CompressBlock(input, pending, output + kLogFrameHeaderSize, sizeof(output) - kLogFrameHeaderSize, table);
+	if(size >= pending) {
+		std::memcpy(output + kLogFrameHeaderSize, input, pending);
+		Write32(output + 4, static_cast<std::uint32_t>(pending) | kLogFrameStored);
+		size = pending;
+	} else {
+		Write32(output + 4, static_cast<std::uint32_t>(size));
+	}
+	Write32(output, static_cast<std::uint32_t>(pending));
+
+	pending = 0;
+	frame	= output;
+	return kLogFrameHeaderSize + size;
+}
+
+void LogCompressor::GetStreamHeader(std::uint8_t (&header)[kLogStreamHeaderSize])
+{
+	std::memcpy(header, kLogStreamMagic, sizeof(kLogStreamMagic));
+	header[4] = kLogStreamVersion;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+Log Compression
+A fast LZ77 compressor in the manner of LZ4, for log text. Text is compressed in blocks of
+up to blockSize bytes, each one on its own, so a damaged or cut off block loses only itself.
+
+A stream is the header "BICZ" and a version byte followed by frames,
+
+	uint32 rawSize		bytes of text in the block, 0 ends the stream
+	uint32 storedSize	bytes following, the high bit set when they are the text as is
+	bytes
+
+A block is a list of sequences, each one a token byte with the number of literals in its high
+and the match length minus 4 in its low nibble, 15 meaning more length bytes follow until one
+is below 255. Then come the literals, a 16 bit little endian offset back to the match and the
+extra match length bytes. The last sequence has literals only.
+
+The stream ends at the first zero frame header, so a preallocated file still being written
+reads fine. tools/logunpack.cpp turns a stream back into text
+*/
+
+static const char		   kLogStreamMagic[4]	= {'B', 'I', 'C', 'Z'};
+static const std::uint8_t  kLogStreamVersion	= 1;
+static const std::uint32_t kLogStreamHeaderSize	= 5;
+static const std::uint32_t kLogFrameHeaderSize	= 8;
+static const std::uint32_t kLogFrameStored		= 0x80000000u;
+
+// Worst case size of a compressed block of size bytes
+inline std::size_t GetCompressBound(std::size_t size)
+{
+	return size + size / 255 + 16;
+}
+
+// Returns the compressed size, 0 when it would not fit in capacity. table holds
+// kCompressTableSize entries of scratch space
+static const std::uint32_t kCompressTableSize = 1 << 12;
+std::size_t CompressBlock(const std::uint8_t* source, std::size_t size, std::uint8_t* destination, std::size_t capacity, std::uint32_t* table);
+
+// False for a damaged block or one that does not fit in capacity
+bool DecompressBlock(const std::uint8_t* source, std::size_t size, std::uint8_t* destination, std::size_t capacity, std::size_t& written);
+
+/*
+LogCompressor
+Collects log text into a block and turns it into a frame once full or when asked to
+*/
+class LogCompressor
+{
+	public:
+	static const std::uint32_t blockSize = 64 * 1024;
+
+	// False when the text does not fit in the block, Finish it first
+	bool Add(const char* text, std::size_t length);
+
+	// Compresses the text collected so far into a frame, returns its size or 0 without text
+	std::size_t Finish(const std::uint8_t*& frame);
+
+	std::size_t GetPending() const { return pending; }
+
+	static void GetStreamHeader(std::uint8_t (&header)[kLogStreamHeaderSize]);
+
+	private:
+	std::uint8_t  input[blockSize];
+	std::uint8_t  output[kLogFrameHeaderSize + blockSize + blockSize / 255 + 16];
+	std::uint32_t table[kCompressTableSize];
+	std::size_t	  pending = 0;
+};
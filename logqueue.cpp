@@ -0,0 +1,313 @@
+#include "logqueue.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <thread>
+
+#include "format.h"
+
+// Records start 8 byte aligned, a ring's end too short for a header is skipped like padding
+struct RecordHeader
+{
+	std::uint64_t sequence;
+	std::int64_t  time;
+	std::uint32_t length;
+	std::uint32_t padding; // Nonzero for the filler before the ring wraps
+};
+
+static const std::uint32_t kRecordAlignment = 8;
+
+static std::uint32_t GetRecordSize(std::uint32_t length)
+{
+	return (sizeof(RecordHeader) + length + kRecordAlignment - 1) & ~(kRecordAlignment - 1);
+}
+
+// One producer, the thread owning it, and one consumer, whoever holds the flush lock
+struct LogQueue::Buffer
+{
+	// On cache lines of their own, the owner and the flushing side each write one of them
+	std::atomic<std::uint64_t> head{0}; // Bytes written, only the owner moves it
+	char					   headLine[64 - sizeof(std::uint64_t)];
+	std::atomic<std::uint64_t> tail{0}; // Bytes consumed, only the flushing side moves it
+	char					   tailLine[64 - sizeof(std::uint64_t)];
+
+	// Set by the owner once it writes to another buffer, nothing more comes into this one
+	std::atomic<Buffer*> next{nullptr};
+	char				 data[bufferSize];
+
+	// The next record to consume, null when the buffer is empty
+	const RecordHeader* Peek()
+	{
+		for(;;) {
+			std::uint64_t read = tail.load(std::memory_order_relaxed);
+			if(read == head.load(std::memory_order_acquire)) { return nullptr; }
+
+			std::uint32_t offset = static_cast<std::uint32_t>(read & (bufferSize - 1));
+			if(bufferSize - offset < sizeof(RecordHeader)) {
+				tail.store(read + (bufferSize - offset), std::memory_order_release);
+				continue;
+			}
+
+			const RecordHeader* header = reinterpret_cast<const RecordHeader*>(data + offset);
+			if(header->padding) {
+				tail.store(read + (bufferSize - offset), std::memory_order_release);
+				continue;
+			}
+			return header;
+		}
+	}
+
+	void Pop(const RecordHeader* header) { tail.store(tail.load(std::memory_order_relaxed) + GetRecordSize(header->length), std::memory_order_release); }
+};
+
+// The chain of buffers one thread logs into
+struct LogQueue::Ring
+{
+	// The owner writes to the newest buffer, the flushing side reads the oldest and leaves it in
+	// spare once drained
+	Buffer*				 writing;
+	Buffer*				 reading;
+	std::atomic<Buffer*> spare{nullptr};
+	Ring*				 next = nullptr;
+
+	explicit Ring(Buffer* buffer) : writing(buffer), reading(buffer) {}
+
+	// Moves past drained buffers. The full one is checked again after seeing its successor,
+	// the last record may have come in between
+	const RecordHeader* Peek()
+	{
+		for(;;) {
+			if(const RecordHeader* header = reading->Peek()) { return header; }
+
+			Buffer* successor = reading->next.load(std::memory_order_acquire);
+			if(!successor) { return nullptr; }
+			if(const RecordHeader* header = reading->Peek()) { return header; }
+
+			Buffer* drained = reading;
+			reading			= successor;
+			drained->head.store(0, std::memory_order_relaxed);
+			drained->tail.store(0, std::memory_order_relaxed);
+			drained->next.store(nullptr, std::memory_order_relaxed);
+			delete spare.exchange(drained, std::memory_order_acq_rel);
+		}
+	}
+};
+
+LogQueue* LogQueue::GetSingleton()
+{
+	static LogQueue instance;
+	return &instance;
+}
+
+LogQueue::Ring* LogQueue::GetRing()
+{
+	// Rings are never freed, a game has a handful of threads that log
+	static thread_local Ring* ring = nullptr;
+	if(ring) { return ring; }
+
+	Buffer* buffer = new(std::nothrow) Buffer();
+	if(!buffer) { return nullptr; }
+
+	ring	   = new Ring(buffer);
+	ring->next = rings.load(std::memory_order_relaxed);
+	while(!rings.compare_exchange_weak(ring->next, ring, std::memory_order_release, std::memory_order_relaxed)) {}
+	return ring;
+}
+
+bool LogQueue::Push(const char* text, std::uint32_t length)
+{
+	Ring* ring = GetRing();
+	if(!ring) {
+		dropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	length			   = std::min<std::uint32_t>(length, bufferSize / 2 - sizeof(RecordHeader));
+	std::uint32_t size = GetRecordSize(length);
+
+	// A record never wraps, the end of the buffer is padded instead
+	Buffer*		  buffer = ring->writing;
+	std::uint64_t write	 = buffer->head.load(std::memory_order_relaxed);
+	std::uint32_t offset = static_cast<std::uint32_t>(write & (bufferSize - 1));
+	std::uint32_t skip	 = bufferSize - offset < size ? bufferSize - offset : 0;
+	if(write + skip + size - buffer->tail.load(std::memory_order_acquire) > bufferSize) {
+		// A full buffer is followed by the drained one the flushing side handed back, or a new one
+		Buffer* successor = ring->spare.exchange(nullptr, std::memory_order_acq_rel);
+		if(!successor) { successor = new(std::nothrow) Buffer(); }
+		if(!successor) {
+			dropped.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		buffer->next.store(successor, std::memory_order_release);
+		ring->writing = successor;
+		buffer		  = successor;
+		write		  = 0;
+		offset		  = 0;
+		skip		  = 0;
+	}
+
+	if(skip) {
+		if(skip >= sizeof(RecordHeader)) { reinterpret_cast<RecordHeader*>(buffer->data + offset)->padding = 1; }
+		write += skip;
+		offset = 0;
+	}
+
+	RecordHeader* header = reinterpret_cast<RecordHeader*>(buffer->data + offset);
+	header->time		 = std::chrono::system_clock::now().time_since_epoch().count();
+	header->length		 = length;
+	header->padding		 = 0;
+	std::memcpy(header + 1, text, length);
+
+	// The sequence is taken last, the gap until the record is published stays short
+	header->sequence = nextSequence.fetch_add(1, std::memory_order_relaxed);
+	buffer->head.store(write + size, std::memory_order_release);
+	return true;
+}
+
+void LogQueue::Flush()
+{
+	std::lock_guard<std::mutex> guard(flushLock);
+	FlushLocked();
+}
+
+bool LogQueue::TryFlush()
+{
+	std::unique_lock<std::mutex> guard(flushLock, std::try_to_lock);
+	if(!guard.owns_lock()) { return false; }
+
+	FlushLocked();
+	return true;
+}
+
+void LogQueue::FlushLocked()
+{
+	if(!writer) { return; }
+
+	// The first record of every ring has the lowest sequence in it, the lowest of those is the
+	// next one to write unless its predecessor is still being written
+	bool wrote = false;
+	for(;;) {
+		Buffer*				bestBuffer = nullptr;
+		const RecordHeader* bestHeader = nullptr;
+		for(Ring* ring = rings.load(std::memory_order_acquire); ring; ring = ring->next) {
+			const RecordHeader* header = ring->Peek();
+			if(header && (!bestHeader || header->sequence < bestHeader->sequence)) {
+				bestBuffer = ring->reading;
+				bestHeader = header;
+			}
+		}
+		if(!bestHeader || bestHeader->sequence != nextWritten) { break; }
+
+		LogRecord record = {bestHeader->sequence, bestHeader->time, bestHeader->length, reinterpret_cast<const char*>(bestHeader + 1)};
+		bool	  repeat = collapseRepeats.load(std::memory_order_relaxed) && lastLength && record.length == lastLength && !std::memcmp(record.text, lastText, record.length);
+		if(repeat) {
+			repeats++;
+		} else {
+			WriteRepeats();
+			writer(record);
+			lastLength = record.length <= sizeof(lastText) ? record.length : 0;
+			std::memcpy(lastText, record.text, lastLength);
+		}
+
+		bestBuffer->Pop(bestHeader);
+		nextWritten++;
+		wrote = true;
+	}
+
+	// Repeats going on are reported once the log has been quiet for an interval
+	if(!wrote) { WriteRepeats(); }
+
+	std::uint64_t lost = dropped.load(std::memory_order_relaxed);
+	if(lost != droppedWritten) {
+		char		text[128];
+		std::size_t length = FormatText(text, sizeof(text), BIC_FMT("ERROR: %u log messages were dropped, there was no memory for their thread's log buffer"), lost - droppedWritten);
+		WriteNote(text, length);
+		droppedWritten = lost;
+	}
+
+	if(flushed) { flushed(); }
+}
+
+void LogQueue::WriteNote(const char* text, std::size_t length)
+{
+	LogRecord record = {nextWritten, std::chrono::system_clock::now().time_since_epoch().count(), static_cast<std::uint32_t>(length), text};
+	writer(record);
+	lastLength = 0;
+}
+
+void LogQueue::WriteRepeats()
+{
+	if(!repeats) { return; }
+
+	char		text[64];
+	std::size_t length = FormatText(text, sizeof(text), BIC_FMT("Last message repeated %u times"), repeats);
+	repeats			   = 0;
+	WriteNote(text, length);
+}
+
+void LogQueue::Start(std::uint32_t intervalMs, Writer logWriter, Flushed logFlushed)
+{
+	{
+		std::lock_guard<std::mutex> guard(flushLock);
+		writer	= logWriter;
+		flushed = logFlushed;
+	}
+
+	// Torn down with the process like the file watcher's thread
+	std::thread([this, intervalMs] {
+		for(;;) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs));
+			Flush();
+		}
+	}).detach();
+}
+
+static std::atomic<std::uint32_t> g_siteBurst(200);
+static std::atomic<std::uint32_t> g_sitePerSecond(100);
+
+void LogSite::SetLimit(std::uint32_t burst, std::uint32_t perSecond)
+{
+	g_siteBurst.store(std::min<std::uint32_t>(std::max<std::uint32_t>(burst, 1), 0xFFFF), std::memory_order_relaxed);
+	g_sitePerSecond.store(perSecond, std::memory_order_relaxed);
+}
+
+bool LogSite::Allow(std::uint32_t& suppressed)
+{
+	suppressed = 0;
+
+	std::uint32_t perSecond = g_sitePerSecond.load(std::memory_order_relaxed);
+	if(!perSecond) { return true; }
+
+	std::uint64_t burst = g_siteBurst.load(std::memory_order_relaxed);
+	std::uint64_t now	= static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count()) & 0xFFFFFFFFFFFFull;
+	std::uint64_t old	= state.load(std::memory_order_relaxed);
+
+	for(;;) {
+		// An unused site starts with a full bucket
+		std::uint64_t last	 = old ? old >> 16 : now;
+		std::uint64_t tokens = old ? old & 0xFFFF : burst;
+
+		// Whole tokens only, the time of the remainder carries over to the next refill
+		std::uint64_t refill = now > last ? (now - last) * perSecond / 1000 : 0;
+		if(tokens + refill >= burst) {
+			tokens = burst;
+			last   = now;
+		} else if(refill) {
+			tokens += refill;
+			last += refill * 1000 / perSecond;
+		}
+
+		if(!tokens) {
+			numSuppressed.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		if(state.compare_exchange_weak(old, (last << 16) | (tokens - 1), std::memory_order_relaxed)) { break; }
+	}
+
+	if(numSuppressed.load(std::memory_order_relaxed)) { suppressed = numSuppressed.exchange(0, std::memory_order_relaxed); }
+	return true;
+}
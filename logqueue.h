@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+
+struct LogRecord
+{
+	std::uint64_t sequence; // Position among every message logged by any thread
+	std::int64_t  time;		// std::chrono::system_clock ticks when it was logged
+	std::uint32_t length;
+	const char*	  text;		// Not terminated
+};
+
+/*
+LogQueue
+Logging from any thread without waiting on another one. Every thread writes into a ring of
+its own, allocated the first time it logs, and one flush thread merges the rings and hands
+the messages to the writer in the order they were logged. That order comes from a sequence
+number taken as a message goes into its ring, so a message whose thread was interrupted
+before finishing it holds back the ones after it until it is there.
+A ring is a chain of buffers. A message finding the thread's buffer full starts another one,
+the flush thread moves on to it once it has drained the full one and hands the drained one
+back to be reused, so nothing is lost while the thread logs faster than the log is written.
+Only a buffer that cannot be allocated drops messages, the writer is told how many were
+lost. A message longer than half a buffer is cut. With collapsing on a message equal to the one before is only counted, once a different
+one comes or the log goes quiet for an interval the writer is told how often it repeated.
+The flush thread lives as long as the process, Flush drains the rings right away and calls
+flushed after every pass, under the same lock as the writer
+*/
+class LogQueue
+{
+	public:
+	typedef std::function<void(const LogRecord&)> Writer;
+	typedef std::function<void()>				  Flushed;
+
+	static const std::uint32_t bufferSize = 64 * 1024;
+
+	static LogQueue* GetSingleton();
+
+	// Messages logged before the flush thread starts wait in their rings
+	void Start(std::uint32_t intervalMs, Writer writer, Flushed flushed = nullptr);
+
+	// False when the message was dropped, which takes running out of memory
+	bool Push(const char* text, std::uint32_t length);
+
+	// Writes every message that is complete and in order, from the calling thread
+	void Flush();
+
+	// Like Flush but gives up when another thread is flushing, which at exit or in a crash
+	// filter may be one that will never finish
+	bool TryFlush();
+
+	std::uint64_t GetDropped() const { return dropped.load(std::memory_order_relaxed); }
+
+	void SetCollapseRepeats(bool collapse) { collapseRepeats.store(collapse, std::memory_order_relaxed); }
+
+	private:
+	struct Buffer;
+	struct Ring;
+
+	LogQueue() = default;
+
+	Ring* GetRing();
+	void  FlushLocked();
+	void  WriteNote(const char* text, std::size_t length);
+	void  WriteRepeats();
+
+	std::atomic<Ring*>		   rings{nullptr};
+	std::atomic<std::uint64_t> nextSequence{0};
+	std::atomic<std::uint64_t> dropped{0};
+	std::atomic<bool>		   collapseRepeats{false};
+
+	// Only the flushing side takes this lock, producers never do
+	std::mutex	  flushLock;
+	Writer		  writer;
+	Flushed		  flushed;
+	std::uint64_t nextWritten	 = 0;
+	std::uint64_t droppedWritten = 0;
+
+	// The last message written, to spot repeats of it
+	char		  lastText[1024];
+	std::uint32_t lastLength = 0;
+	std::uint32_t repeats	 = 0;
+};
+
+/*
+LogSite
+A token bucket rate limiting one line of code that logs. The bucket holds burst messages and
+refills at perSecond, a message finding it empty is suppressed before it is even formatted,
+which costs a clock read and an atomic compare exchange. The next message let through reports
+how many were suppressed. Every site shares the limit, 0 per second turns it off.
+
+LogMessage keeps one static LogSite per BIC_FMT format, the type of the format identifies the
+call site, so finding its bucket costs nothing
+*/
+class LogSite
+{
+	public:
+	LogSite() = default;
+
+	// False when the site is over its rate. suppressed is set to the number of messages it
+	// dropped since the last one it let through
+	bool Allow(std::uint32_t& suppressed);
+
+	static void SetLimit(std::uint32_t burst, std::uint32_t perSecond);
+
+	private:
+	std::atomic<std::uint64_t> state{0}; // Tokens in the low 16 bits, the ms of the last refill above
+	std::atomic<std::uint32_t> numSuppressed{0};
+};
@@ -8,59 +8,83 @@ class Plugin_BestInClassPP_OpenHandle : public BSTEventSink<MenuOpenCloseEvent>,
 
 	virtual EventResult ReceiveEvent(MenuOpenCloseEvent* evn, BSTEventSource<MenuOpenCloseEvent>* src) override
 	{
-		UIStringHolder* holder = UIStringHolder::GetSingleton();
+		const MenuRegistry::Entry* entry = MenuRegistry::GetSingleton()->Find(evn->menuName);
+		if(!entry) { return kEvent_Continue; }
 
-		if(evn->opening && (evn->menuName == holder->inventoryMenu || evn->menuName == holder->barterMenu || evn->menuName == holder->containerMenu)) {
-			LogMessage("Menu \"%s\" has been opened", evn->menuName);
+		// The entries of a closed menu are freed, the next list may reuse their addresses
+		if(!evn->opening) {
+			ForgetRankedList();
+			return kEvent_Continue;
+		}
 
-			MenuManager* mm = MenuManager::GetSingleton();
+		LogMessage(BIC_FMT("Menu \"%s\" has been opened"), evn->menuName.c_str());
 
-			if(evn->menuName == holder->inventoryMenu) {
-				IMenu*						 menu		   = mm->GetMenu(holder->inventoryMenu);
-				InventoryMenu*				 invMenu	   = dynamic_cast<InventoryMenu*>(menu);
-				BSTArray<StandardItemData*>& itemDataArray = invMenu->inventoryData->items;
+		IMenu* menu = MenuManager::GetSingleton()->GetMenu(*entry->name);
 
-				LogMessage("EVENT: InventoryMenu is at address %08X", invMenu);
-				ProcessInventory(itemDataArray);
+		if(menu) {
+			BSTArray<StandardItemData*>& itemDataArray = *entry->accessor(menu);
 
-			} else if(evn->menuName == holder->barterMenu) {
-				IMenu*						 menu		   = mm->GetMenu(holder->barterMenu);
-				BarterMenu*					 barMenu	   = dynamic_cast<BarterMenu*>(menu);
-				BSTArray<StandardItemData*>& itemDataArray = barMenu->barterInventoryData->items;
+			// Skip the second full pass when the hook already ranked this list
+			if(WasRanked(itemDataArray)) {
+				LogVerbose(BIC_FMT("EVENT: %s was already ranked by the hook"), entry->label);
+			} else {
+				LogMessage(BIC_FMT("EVENT: %s is at address %p"), entry->label, menu);
+				ProcessInventory(itemDataArray, entry->listFlags, entry->label);
+			}
+		}
 
-				LogMessage("EVENT: BarterMenu is at address %08X", barMenu);
-				ProcessInventory(itemDataArray);
-			} else if(evn->menuName == holder->containerMenu) {
-				IMenu*						 menu		   = mm->GetMenu(holder->containerMenu);
-				ContainerMenu*				 conMenu	   = dynamic_cast<ContainerMenu*>(menu);
-				BSTArray<StandardItemData*>& itemDataArray = conMenu->inventoryData->items;
+		return kEvent_Continue;
+	}
+};
 
-				LogMessage("EVENT: ContainerMenu is at address %08X", conMenu);
-				ProcessInventory(itemDataArray);
-			}
+class Plugin_BestInClassPP_ContainerHandle : public BSTEventSink<TESContainerChangedEvent>, public Plugin_BestInClassPP_Proc
+{
+	public:
+	Plugin_BestInClassPP_ContainerHandle() {}
 
-			return kEvent_Continue;
-		} else {
-			return kEvent_Continue;
-		}
+	virtual EventResult ReceiveEvent(TESContainerChangedEvent* evn, BSTEventSource<TESContainerChangedEvent>* src) override
+	{
+		constexpr UInt32 playerFormID = 0x14;
+
+		if(evn->toFormId == playerFormID) { OnPlayerItemChanged(evn->itemFormId, evn->count); }
+		if(evn->fromFormId == playerFormID) { OnPlayerItemChanged(evn->itemFormId, -static_cast<SInt32>(evn->count)); }
+
+		return kEvent_Continue;
+	}
+};
+
+class Plugin_BestInClassPP_EquipHandle : public BSTEventSink<TESEquipEvent>, public Plugin_BestInClassPP_Proc
+{
+	public:
+	Plugin_BestInClassPP_EquipHandle() {}
+
+	virtual EventResult ReceiveEvent(TESEquipEvent* evn, BSTEventSource<TESEquipEvent>* src) override
+	{
+		if(evn->actor == PlayerCharacter::GetSingleton()) { OnPlayerEquipChanged(evn->baseObject, evn->equipped); }
+
+		return kEvent_Continue;
 	}
 };
 
 class Plugin_BestInClassPP_SKSE : public SKSEPlugin, public Plugin_BestInClassPP_Proc
 {
-	Plugin_BestInClassPP_OpenHandle OpenHandler;
+	Plugin_BestInClassPP_OpenHandle		 OpenHandler;
+	Plugin_BestInClassPP_ContainerHandle ContainerHandler;
+	Plugin_BestInClassPP_EquipHandle	 EquipHandler;
 
 	virtual bool InitInstance() override
 	{
-		LogMessage("Initializing %s", g_pluginName);
+		LogMessage(BIC_FMT("Initializing %s"), g_pluginName);
 		if(!Requires(kSKSEVersion_1_7_1, SKSEPapyrusInterface::Version_1)) {
-			LogMessage("ERROR: Your SKSE Version is too old");
+			LogMessage(BIC_FMT("ERROR: Your SKSE Version is too old"));
 			return false;
 		}
 
 		SetName(g_pluginName);
 		SetVersion(g_pluginVersion);
 
+		LoadConfig(g_configPath);
+
 		{
 			auto  v		= g_pluginVersion;
 			UInt8 main	= v >> 0x18;
@@ -75,7 +99,7 @@ class Plugin_BestInClassPP_SKSE : public SKSEPlugin, public Plugin_BestInClassPP
 				case Candidate: rType = "Candidate"; break;
 				case Release: rType = "Release"; break;
 			}
-			LogMessage("Current version is %d.%d.%d (%s)", main, major, minor, rType);
+			LogMessage(BIC_FMT("Current version is %d.%d.%d (%s)"), main, major, minor, rType);
 		}
 
 		return true;
@@ -83,19 +107,32 @@ class Plugin_BestInClassPP_SKSE : public SKSEPlugin, public Plugin_BestInClassPP
 
 	virtual bool OnLoad() override
 	{
-		LogMessage("Registering for SKSE events");
+		LogMessage(BIC_FMT("Registering for SKSE events"));
 
 		MenuManager* mm = MenuManager::GetSingleton();
 		mm->BSTEventSource<MenuOpenCloseEvent>::AddEventSink(&OpenHandler);
 
-		// LogMessage("Disabling vanilla bestInClass function at memory location %08X", 0x008684A0);
+		// LogMessage(BIC_FMT("Disabling vanilla bestInClass function at memory location %08X"), 0x008684A0);
 		// SafeWrite8(0x008684A0, 0xC3);
 
-		LogMessage("Hooking the vanilla function at %08X", 0x008684A0);
+		LogMessage(BIC_FMT("Hooking the vanilla function at %08X"), 0x008684A0);
 		InstallHook();
 
 		return true;
 	}
 
-	virtual void OnModLoaded() override {}
+	virtual void OnModLoaded() override
+	{
+		MenuRegistry::GetSingleton()->RegisterDefaultMenus();
+
+		LogMessage(BIC_FMT("Registering for container and equip changes"));
+		ScriptEventSourceHolder* events = ScriptEventSourceHolder::GetSingleton();
+		events->BSTEventSource<TESContainerChangedEvent>::AddEventSink(&ContainerHandler);
+		events->BSTEventSource<TESEquipEvent>::AddEventSink(&EquipHandler);
+
+		LogMessage(BIC_FMT("Building the keyword index"));
+		OnDataLoaded(g_configPath);
+
+		WatchConfig(g_configPath);
+	}
 } thePlugin;
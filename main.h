@@ -4,6 +4,7 @@
 
 #include <SKSE/DebugLog.h>
 #include <SKSE/GameData.h>
+#include <SKSE/GameEvents.h>
 #include <SKSE/GameExtraData.h>
 #include <SKSE/GameForms.h>
 #include <SKSE/GameMenus.h>
@@ -18,4 +19,5 @@
 #include <SKSE/Version.h>
 
 #include "hook.h"
+#include "menus.h"
 #include "processor.h"
@@ -0,0 +1,183 @@
+#include "mappedfile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const char* path)
+{
+	Close();
+
+	// Snapshots keep the file mapped for as long as they live, sharing delete lets rulec rename a new
+	// file over it meanwhile
+	HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if(handle == INVALID_HANDLE_VALUE) { return false; }
+	file = handle;
+
+	LARGE_INTEGER fileSize;
+	if(!GetFileSizeEx(handle, &fileSize) || fileSize.QuadPart == 0 || static_cast<std::uint64_t>(fileSize.QuadPart) > SIZE_MAX) {
+		Close();
+		return false;
+	}
+
+	mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if(!mapping) {
+		Close();
+		return false;
+	}
+
+	data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if(!data) {
+		Close();
+		return false;
+	}
+
+	size = static_cast<std::size_t>(fileSize.QuadPart);
+	return true;
+}
+
+bool MappedFile::Create(const char* path, std::size_t fileSize)
+{
+	Close();
+
+	HANDLE handle = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if(handle == INVALID_HANDLE_VALUE) { return false; }
+	file = handle;
+
+	LARGE_INTEGER end;
+	end.QuadPart = static_cast<LONGLONG>(fileSize);
+	if(!fileSize || !SetFilePointerEx(handle, end, nullptr, FILE_BEGIN) || !SetEndOfFile(handle)) {
+		Close();
+		return false;
+	}
+
+	mapping = CreateFileMappingA(handle, nullptr, PAGE_READWRITE, 0, 0, nullptr);
+	if(!mapping) {
+		Close();
+		return false;
+	}
+
+	data = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, 0);
+	if(!data) {
+		Close();
+		return false;
+	}
+
+	size	 = fileSize;
+	writable = true;
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if(data) { UnmapViewOfFile(data); }
+	if(mapping) { CloseHandle(mapping); }
+	if(file) { CloseHandle(file); }
+
+	data	 = nullptr;
+	mapping	 = nullptr;
+	file	 = nullptr;
+	size	 = 0;
+	writable = false;
+}
+
+bool MappedFile::Close(std::size_t keep)
+{
+	bool cut = false;
+	if(writable && file) {
+		// The file can only shrink once nothing maps it any more
+		UnmapViewOfFile(data);
+		CloseHandle(mapping);
+		data	= nullptr;
+		mapping = nullptr;
+
+		LARGE_INTEGER end;
+		end.QuadPart = static_cast<LONGLONG>(keep < size ? keep : size);
+		cut = SetFilePointerEx(file, end, nullptr, FILE_BEGIN) && SetEndOfFile(file);
+	}
+	Close();
+	return cut;
+}
+
+#else
+
+bool MappedFile::Open(const char* path)
+{
+	Close();
+
+	fd = open(path, O_RDONLY);
+	if(fd == -1) { return false; }
+
+	struct stat info;
+	if(fstat(fd, &info) != 0 || info.st_size == 0) {
+		Close();
+		return false;
+	}
+
+	void* view = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	if(view == MAP_FAILED) {
+		Close();
+		return false;
+	}
+
+	data = view;
+	size = static_cast<std::size_t>(info.st_size);
+	return true;
+}
+
+bool MappedFile::Create(const char* path, std::size_t fileSize)
+{
+	Close();
+
+	fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if(fd == -1) { return false; }
+
+	// posix_fallocate reserves the blocks, a file system without it still gets a sparse file
+	if(!fileSize || (posix_fallocate(fd, 0, static_cast<off_t>(fileSize)) != 0 && ftruncate(fd, static_cast<off_t>(fileSize)) != 0)) {
+		Close();
+		return false;
+	}
+
+	void* view = mmap(nullptr, fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if(view == MAP_FAILED) {
+		Close();
+		return false;
+	}
+
+	data	 = view;
+	size	 = fileSize;
+	writable = true;
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if(data) { munmap(data, size); }
+	if(fd != -1) { close(fd); }
+
+	data	 = nullptr;
+	fd		 = -1;
+	size	 = 0;
+	writable = false;
+}
+
+bool MappedFile::Close(std::size_t keep)
+{
+	bool cut = false;
+	if(writable && fd != -1) {
+		munmap(data, size);
+		data = nullptr;
+		cut	 = ftruncate(fd, static_cast<off_t>(keep < size ? keep : size)) == 0;
+	}
+	Close();
+	return cut;
+}
+
+#endif
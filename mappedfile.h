@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+MappedFile
+Memory mapping of a whole file, the view stays valid until Close or destruction. Open maps an
+existing file read-only, Create makes a new one of the given size and maps it writable
+*/
+class MappedFile
+{
+	public:
+	MappedFile() = default;
+	~MappedFile() { Close(); }
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool Open(const char* path);
+	void Close();
+
+	// Replaces the file at path with one of size bytes, its disk space is allocated up front
+	bool Create(const char* path, std::size_t size);
+
+	// Unmaps a file made by Create and cuts it to its first keep bytes, false when it could not
+	// be cut
+	bool Close(std::size_t keep);
+
+	bool				IsOpen() const { return data != nullptr; }
+	const std::uint8_t* GetData() const { return static_cast<const std::uint8_t*>(data); }
+	std::uint8_t*		GetWritableData() const { return writable ? static_cast<std::uint8_t*>(data) : nullptr; }
+	std::size_t			GetSize() const { return size; }
+
+	private:
+#ifdef _WIN32
+	void* file	  = nullptr;
+	void* mapping = nullptr;
+#else
+	int fd = -1;
+#endif
+	void*		data	 = nullptr;
+	std::size_t size	 = 0;
+	bool		writable = false;
+};
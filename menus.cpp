@@ -0,0 +1,45 @@
+#include "menus.h"
+#include "processor.h"
+
+MenuRegistry* MenuRegistry::GetSingleton()
+{
+	static MenuRegistry instance;
+	return &instance;
+}
+
+void MenuRegistry::Register(const BSFixedString& name, const char* label, UInt32 listFlags, ItemAccessor accessor)
+{
+	Entry& entry = entries[name.c_str()];
+	bool   added = entry.name == nullptr;
+
+	entry.name		= &name;
+	entry.label		= label;
+	entry.listFlags = listFlags;
+	entry.accessor	= accessor;
+
+	// unordered_map never moves its elements, the pointers stay valid
+	if(added) { order.push_back(&entry); }
+}
+
+void MenuRegistry::RegisterDefaultMenus()
+{
+	UIStringHolder* holder = UIStringHolder::GetSingleton();
+
+	Register(holder->inventoryMenu, "InventoryMenu", kList_PlayerInventory, [](IMenu* menu) { return &static_cast<InventoryMenu*>(menu)->inventoryData->items; });
+	Register(holder->barterMenu, "BarterMenu", kList_CompareWithPlayer, [](IMenu* menu) { return &static_cast<BarterMenu*>(menu)->barterInventoryData->items; });
+	Register(holder->containerMenu, "ContainerMenu", kList_CompareWithPlayer, [](IMenu* menu) { return &static_cast<ContainerMenu*>(menu)->inventoryData->items; });
+}
+
+const MenuRegistry::Entry* MenuRegistry::Find(const BSFixedString& name) const
+{
+	auto it = entries.find(name.c_str());
+	return it != entries.end() ? &it->second : nullptr;
+}
+
+const MenuRegistry::Entry* MenuRegistry::FindOpen(MenuManager* mm) const
+{
+	for(const Entry* entry : order) {
+		if(mm->IsMenuOpen(*entry->name)) { return entry; }
+	}
+	return nullptr;
+}
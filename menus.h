@@ -0,0 +1,44 @@
+#pragma once
+
+#include <SKSE.h>
+
+#include <SKSE/GameMenus.h>
+
+#include <unordered_map>
+#include <vector>
+
+/*
+MenuRegistry
+Maps the interned name of every menu we rank to a typed accessor for its item list and the
+ItemListFlags describing what the list holds.
+Menu names are BSFixedStrings, so equal names share one pointer and a lookup is a single
+pointer hash. The accessor knows the menu's class, no RTTI is involved
+*/
+class MenuRegistry
+{
+	public:
+	typedef BSTArray<StandardItemData*>* (*ItemAccessor)(IMenu* menu);
+
+	struct Entry
+	{
+		const BSFixedString* name;
+		const char*			 label;
+		UInt32				 listFlags;
+		ItemAccessor		 accessor;
+	};
+
+	static MenuRegistry* GetSingleton();
+
+	// The name must outlive the registry, the strings of the UIStringHolder do
+	void Register(const BSFixedString& name, const char* label, UInt32 listFlags, ItemAccessor accessor);
+	void RegisterDefaultMenus();
+
+	const Entry* Find(const BSFixedString& name) const;
+
+	// The first registered menu that is currently open, in registration order
+	const Entry* FindOpen(MenuManager* mm) const;
+
+	private:
+	std::unordered_map<const char*, Entry> entries;
+	std::vector<const Entry*>			   order;
+};
@@ -0,0 +1,98 @@
+#include "playerbest.h"
+
+#include <cfloat>
+
+void PlayerBestIndex::Reset(std::uint32_t generation, std::uint32_t numCategories)
+{
+	std::lock_guard<std::mutex> guard(lock);
+
+	owned.clear();
+	bestScore.assign(numCategories, -FLT_MAX);
+	bestKey.assign(numCategories, {0, nullptr});
+	stale.assign(numCategories, false);
+	this->generation = generation;
+	seeded			 = true;
+}
+
+void PlayerBestIndex::Add(std::uint32_t generation, std::uint32_t formID, const void* extra, int category, float score, std::int32_t count)
+{
+	if(count < 0) { return Remove(generation, formID, -count); }
+
+	std::lock_guard<std::mutex> guard(lock);
+	if(!seeded || this->generation != generation || category < 0 || static_cast<std::uint32_t>(category) >= bestScore.size()) { return; }
+
+	Owned& entry   = owned[{formID, extra}];
+	entry.category = category;
+	entry.score	   = score;
+
+	entry.count += count;
+
+	if(!stale[category] && score > bestScore[category]) {
+		bestScore[category] = score;
+		bestKey[category]	= {formID, extra};
+	}
+}
+
+void PlayerBestIndex::Remove(std::uint32_t generation, std::uint32_t formID, std::int32_t count)
+{
+	std::lock_guard<std::mutex> guard(lock);
+	if(!seeded || this->generation != generation) { return; }
+
+	auto plain = owned.find({formID, nullptr});
+	if(plain != owned.end()) { count = Take(plain, count); }
+
+	// Only walks the index when more left than the plain entry had
+	for(auto it = owned.begin(); count > 0 && it != owned.end();) {
+		if(it->first.formID == formID) {
+			count = Take(it, count);
+		} else {
+			++it;
+		}
+	}
+}
+
+std::int32_t PlayerBestIndex::Take(OwnedMap::iterator& it, std::int32_t count)
+{
+	std::int32_t taken = count < it->second.count ? count : it->second.count;
+	it->second.count -= taken;
+	if(it->second.count > 0) { return count - taken; }
+
+	// Losing the last of the best entry means the next best has to be found, but only
+	// once someone asks for it
+	int category = it->second.category;
+	if(bestKey[category] == it->first) { stale[category] = true; }
+	it = owned.erase(it);
+	return count - taken;
+}
+
+bool PlayerBestIndex::IsCurrent(std::uint32_t generation) const
+{
+	std::lock_guard<std::mutex> guard(lock);
+	return seeded && this->generation == generation;
+}
+
+bool PlayerBestIndex::GetBestScores(std::uint32_t generation, float* scores, std::uint32_t numCategories)
+{
+	std::lock_guard<std::mutex> guard(lock);
+	if(!seeded || this->generation != generation || numCategories != bestScore.size()) { return false; }
+
+	for(std::uint32_t i = 0; i < numCategories; i++) {
+		if(stale[i]) { Rebuild(i); }
+		scores[i] = bestScore[i];
+	}
+	return true;
+}
+
+void PlayerBestIndex::Rebuild(std::uint32_t category)
+{
+	bestScore[category] = -FLT_MAX;
+	bestKey[category]	= {0, nullptr};
+
+	for(const auto& entry : owned) {
+		if(entry.second.category == static_cast<int>(category) && entry.second.score > bestScore[category]) {
+			bestScore[category] = entry.second.score;
+			bestKey[category]	= entry.first;
+		}
+	}
+	stale[category] = false;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+/*
+PlayerBestIndex
+The best score per category among a set of the player's items, so items can be compared
+against the player's inventory or equipped gear without walking it. Items are keyed by form and
+extra list like the item groups, a player enchanted copy has its own entry next to the plain
+ones of its form, whose extra is null. Seeded by the first pass of any menu after a reload, or
+a ranked InventoryMenu pass, and kept current from container change and equip events. Scores
+belong to one configuration generation, after a reload the index is ignored until it is seeded
+again.
+Events arrive on the game thread and menus are ranked on the UI thread, hence the lock
+*/
+class PlayerBestIndex
+{
+	public:
+	// Drops everything owned, the following Adds describe the complete inventory
+	void Reset(std::uint32_t generation, std::uint32_t numCategories);
+
+	// A negative count removes items, forms without a category are never added
+	void Add(std::uint32_t generation, std::uint32_t formID, const void* extra, int category, float score, std::int32_t count);
+
+	// Events do not tell the copies of a form apart, the plain ones are taken first
+	void Remove(std::uint32_t generation, std::uint32_t formID, std::int32_t count);
+
+	bool IsCurrent(std::uint32_t generation) const;
+
+	// Copies the best score of every category, -FLT_MAX where none of the items are. False if the
+	// index does not match the generation
+	bool GetBestScores(std::uint32_t generation, float* scores, std::uint32_t numCategories);
+
+	private:
+	struct Key
+	{
+		std::uint32_t formID;
+		const void*	  extra;
+
+		bool operator==(const Key& other) const { return formID == other.formID && extra == other.extra; }
+	};
+
+	struct KeyHash
+	{
+		std::size_t operator()(const Key& key) const { return std::hash<const void*>()(key.extra) ^ key.formID; }
+	};
+
+	struct Owned
+	{
+		int			 category;
+		float		 score;
+		std::int32_t count;
+	};
+
+	typedef std::unordered_map<Key, Owned, KeyHash> OwnedMap;
+
+	// Takes up to count items of the entry, which is erased once empty. Returns how many are
+	// left to take
+	std::int32_t Take(OwnedMap::iterator& it, std::int32_t count);
+	void		 Rebuild(std::uint32_t category);
+
+	mutable std::mutex lock;
+	OwnedMap		   owned;
+	std::vector<float> bestScore;
+	std::vector<Key>   bestKey;
+	std::vector<bool>  stale;
+	std::uint32_t	   generation = 0;
+	bool			   seeded	  = false;
+};
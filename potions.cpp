@@ -0,0 +1,143 @@
+#include "potions.h"
+#include "formdispatch.h"
+
+#include <SKSE.h>
+
+#include <SKSE/GameData.h>
+#include <SKSE/GameForms.h>
+#include <SKSE/GameObjects.h>
+
+#include <algorithm>
+
+// The costliest effect is the one the game names the potion after
+static EffectItem* GetPrimaryEffect(AlchemyItem* alchemyItem)
+{
+	if(!alchemyItem || alchemyItem->IsFood()) { return nullptr; }
+
+	EffectItem* effectItem = alchemyItem->GetCostliestEffectItem();
+	return effectItem && effectItem->mgef ? effectItem : nullptr;
+}
+
+static float GetPotionScore(const EffectItem* effectItem)
+{
+	return effectItem->magnitude * std::max<UInt32>(effectItem->duration, 1);
+}
+
+void PotionIndex::Resolve()
+{
+	effectFormIDs.clear();
+	effectIndices.clear();
+	potions.clear();
+
+	for(AlchemyItem* alchemyItem : DataHandler::GetSingleton()->arrALCH) {
+		EffectItem* effectItem = GetPrimaryEffect(alchemyItem);
+		if(!effectItem) { continue; }
+
+		auto inserted = effectIndices.emplace(effectItem->mgef, static_cast<std::uint32_t>(effectFormIDs.size()));
+		if(inserted.second) { effectFormIDs.push_back(effectItem->mgef->GetFormID()); }
+
+		potions[alchemyItem] = {inserted.first->second, GetPotionScore(effectItem)};
+	}
+}
+
+bool PotionIndex::GetPotion(TESForm* form, std::uint32_t& effect, float& score) const
+{
+	auto it = potions.find(form);
+	if(it == potions.end()) { return false; }
+
+	effect = it->second.effect;
+	score  = it->second.score;
+	return true;
+}
+
+bool PotionIndex::GetEffectIndex(const EffectSetting* mgef, std::uint32_t& effect) const
+{
+	auto it = effectIndices.find(mgef);
+	if(it == effectIndices.end()) { return false; }
+
+	effect = it->second;
+	return true;
+}
+
+bool RuntimePotions::GetPotion(std::uint32_t generation, const PotionIndex& index, TESForm* form, std::uint32_t& effect, float& score)
+{
+	std::lock_guard<std::mutex> guard(lock);
+
+	// The effect indices follow the PotionIndex of one generation
+	if(generation != this->generation) {
+		potions.clear();
+		effectIndices.clear();
+		effectFormIDs.clear();
+		this->generation = generation;
+	}
+
+	auto it = potions.find(form);
+	if(it == potions.end()) {
+		Potion		potion	   = {false, 0, 0.0f};
+		EffectItem* effectItem = GetPrimaryEffect(FormCast<AlchemyItem>(form));
+		if(effectItem) {
+			potion.score  = GetPotionScore(effectItem);
+			potion.ranked = index.GetEffectIndex(effectItem->mgef, potion.effect);
+			if(!potion.ranked) {
+				auto found = effectIndices.find(effectItem->mgef);
+				if(found == effectIndices.end() && effectFormIDs.size() < maxEffects) {
+					found = effectIndices.emplace(effectItem->mgef, static_cast<std::uint32_t>(effectFormIDs.size())).first;
+					effectFormIDs.push_back(effectItem->mgef->GetFormID());
+				}
+				potion.ranked = found != effectIndices.end();
+				if(potion.ranked) { potion.effect = index.GetNumEffects() + found->second; }
+			}
+		}
+		it = potions.emplace(form, potion).first;
+	}
+
+	effect = it->second.effect;
+	score  = it->second.score;
+	return it->second.ranked;
+}
+
+std::uint32_t RuntimePotions::GetEffectFormID(std::uint32_t effect) const
+{
+	std::lock_guard<std::mutex> guard(lock);
+	return effect < effectFormIDs.size() ? effectFormIDs[effect] : 0;
+}
+
+void IngredientIndex::Resolve()
+{
+	effectBits.clear();
+	ingredients.clear();
+
+	for(IngredientItem* ingredientItem : DataHandler::GetSingleton()->arrINGR) {
+		if(!ingredientItem) { continue; }
+
+		Ingredient ingredient	 = {};
+		ingredient.formID		 = ingredientItem->GetFormID();
+		ingredient.totalStrength = 0.0f;
+
+		for(EffectItem* effectItem : ingredientItem->effectItemList) {
+			if(!effectItem || !effectItem->mgef || ingredient.numEffects == Ingredient::maxEffects) { continue; }
+
+			// Effects get their bit on first sight, the ones past maxBits are left out
+			auto inserted = effectBits.emplace(effectItem->mgef, static_cast<std::uint32_t>(effectBits.size()));
+			if(inserted.first->second >= EffectSet::maxBits) { continue; }
+
+			std::uint32_t bit	   = inserted.first->second;
+			float		  strength = GetPotionScore(effectItem);
+
+			ingredient.effects.Set(bit);
+			ingredient.effectBits[ingredient.numEffects] = static_cast<std::uint16_t>(bit);
+			ingredient.strengths[ingredient.numEffects]	 = strength;
+			ingredient.numEffects++;
+
+			ingredient.totalStrength += strength;
+		}
+
+		if(ingredient.numEffects) { ingredients[ingredientItem] = ingredient; }
+	}
+}
+
+const Ingredient* IngredientIndex::GetIngredient(TESForm* form) const
+{
+	auto it = ingredients.find(form);
+	return it != ingredients.end() ? &it->second : nullptr;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "alchemy.h"
+
+class EffectSetting;
+class TESForm;
+
+/*
+PotionIndex
+Potions and poisons grouped by their primary effect, the effect with the highest cost. Every
+primary effect in the load order gets a dense index and each potion's score, magnitude times
+duration, is computed once when the data is loaded, so ranking never walks an effect list.
+Instant effects count as lasting one second
+*/
+class PotionIndex
+{
+	public:
+	// Needs the game data to be loaded, food is left out
+	void Resolve();
+
+	// False for forms that are not potions of the load order, see RuntimePotions for brewed ones
+	bool GetPotion(TESForm* form, std::uint32_t& effect, float& score) const;
+
+	// False when no potion of the load order has the effect as its primary one
+	bool GetEffectIndex(const EffectSetting* mgef, std::uint32_t& effect) const;
+
+	std::uint32_t GetNumEffects() const { return static_cast<std::uint32_t>(effectFormIDs.size()); }
+	std::uint32_t GetEffectFormID(std::uint32_t effect) const { return effectFormIDs[effect]; }
+	std::uint32_t GetNumPotions() const { return static_cast<std::uint32_t>(potions.size()); }
+
+	private:
+	struct Potion
+	{
+		std::uint32_t effect;
+		float		  score;
+	};
+
+	std::vector<std::uint32_t>							    effectFormIDs;
+	std::unordered_map<const EffectSetting*, std::uint32_t> effectIndices;
+	std::unordered_map<const TESForm*, Potion>			    potions;
+};
+
+/*
+RuntimePotions
+Brewed potions are created at runtime and are not in the PotionIndex. The first lookup of one
+walks its effect list, after that the result is kept per form until the configuration
+generation changes, forms that turn out not to be potions included. A primary effect no
+potion of the load order has gets an index after the PotionIndex's own, up to maxEffects of
+them, so those potions are ranked against each other as well
+*/
+class RuntimePotions
+{
+	public:
+	static const std::uint32_t maxEffects = 32;
+
+	// effect is an index among the PotionIndex's effects followed by the ones added here
+	bool GetPotion(std::uint32_t generation, const PotionIndex& index, TESForm* form, std::uint32_t& effect, float& score);
+
+	// The effect of index.GetNumEffects() + effect, 0 when none has it yet
+	std::uint32_t GetEffectFormID(std::uint32_t effect) const;
+
+	private:
+	struct Potion
+	{
+		bool		  ranked;
+		std::uint32_t effect;
+		float		  score;
+	};
+
+	mutable std::mutex										lock;
+	std::uint32_t											generation = 0;
+	std::unordered_map<const TESForm*, Potion>				potions;
+	std::unordered_map<const EffectSetting*, std::uint32_t> effectIndices;
+	std::vector<std::uint32_t>								effectFormIDs;
+};
+
+/*
+IngredientIndex
+Every effect an ingredient can have gets a dense bit for the EffectSet, and each ingredient's
+effects and their strengths, scored like potions, are kept with it so the AlchemySolver only
+compares bits. Ingredients past the first EffectSet::maxBits effects lose the rest
+*/
+class IngredientIndex
+{
+	public:
+	// Needs the game data to be loaded
+	void Resolve();
+
+	// Null for forms that are not ingredients
+	const Ingredient* GetIngredient(TESForm* form) const;
+
+	std::uint32_t GetNumEffects() const { return static_cast<std::uint32_t>(effectBits.size()); }
+	std::uint32_t GetNumIngredients() const { return static_cast<std::uint32_t>(ingredients.size()); }
+
+	private:
+	std::unordered_map<const EffectSetting*, std::uint32_t> effectBits;
+	std::unordered_map<const TESForm*, Ingredient>		    ingredients;
+};
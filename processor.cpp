@@ -2,7 +2,8 @@
 
 /*
 bestItem/bestValue Array Index Assignment
-The bestItemArray assigns an item type to an index
+The bestItemArray assigns an item category to an index, categories are numbered in the order
+the rules declare them. The built-in rules in rules.cpp keep the original assignment
 
 Armors
 0	LightArmor		| 5	HeavyArmor
@@ -25,184 +26,1035 @@ Clothing
 21 ClothingShoes	| 23 ClothingHat
 */
 
-void Plugin_BestInClassPP_Proc::LogMessage(const char* fmt, ...)
-{
-	va_list args;
-	va_start(args, fmt);
-	char inputBuf[1024];
-	vsprintf_s(inputBuf, fmt, args);
-	va_end(args);
-
-	std::string date = date::format("%F %T", std::chrono::system_clock::now());
-
-	_MESSAGE("[%s] %s", date.c_str(), inputBuf);
-}
-
-void Plugin_BestInClassPP_Proc::ProcessInventory(BSTArray<StandardItemData*>& itemDataArray)
-{
-	LogMessage("The itemDataArray is at address %08X", &itemDataArray);
-
-	std::fill_n(bestItemArray, arraySize, nullptr);
-	std::fill_n(bestValueArray, arraySize, 0);
-
-	if(!itemDataArray.empty()) {
-		for(StandardItemData* itemData : itemDataArray) {
-			TESForm* baseForm = itemData->objDesc->baseForm;
-
-			if(baseForm) {
-				int targetIndex = -1;
-				if(baseForm->IsWeapon()) {
-					LogMessage("Item %s has baseFormID %08X", itemData->GetName(), baseForm->GetFormID());
-					TESObjectWEAP* objWEAP = DYNAMIC_CAST<TESObjectWEAP*>(baseForm);
-
-					if(objWEAP) {
-						LogMessage("Weapon %s has type %d", itemData->GetName(), objWEAP->gameData.type);
-						switch(objWEAP->type()) {
-							case TESObjectWEAP::GameData::kType_1HS:
-							case TESObjectWEAP::GameData::kType_OneHandSword: // Sword
-								targetIndex = 10;
-								break;
-							case TESObjectWEAP::GameData::kType_1HD:
-							case TESObjectWEAP::GameData::kType_OneHandDagger: // Dagger
-								targetIndex = 13;
-								break;
-							case TESObjectWEAP::GameData::kType_1HA:
-							case TESObjectWEAP::GameData::kType_OneHandAxe: // Axe
-								targetIndex = 11;
-								break;
-							case TESObjectWEAP::GameData::kType_1HM:
-							case TESObjectWEAP::GameData::kType_OneHandMace: // Mace
-								targetIndex = 12;
-								break;
-							case TESObjectWEAP::GameData::kType_2HS:
-							case TESObjectWEAP::GameData::kType_TwoHandSword: // Greatsword
-								targetIndex = 14;
-								break;
-							case TESObjectWEAP::GameData::kType_2HA:
-							case TESObjectWEAP::GameData::kType_TwoHandAxe: // Battleaxe
-								targetIndex = 15;
-								break;
-							case TESObjectWEAP::GameData::kType_Bow2:
-							case TESObjectWEAP::GameData::kType_Bow: // Bow
-								targetIndex = 16;
-								break;
-							case TESObjectWEAP::GameData::kType_CBow:
-							case TESObjectWEAP::GameData::kType_CrossBow: // Crossbow
-								targetIndex = 17;
-								break;
-							default: targetIndex = -1; break;
-						}
-						if(targetIndex != -1) {
-							if(bestItemArray[targetIndex]) { LogMessage("		Last Item: %s with %d damage", bestItemArray[targetIndex]->GetName(), bestValueArray[targetIndex]); }
-							if(objWEAP->attackDamage > bestValueArray[targetIndex]) {
-								bestItemArray[targetIndex]	= itemData;
-								bestValueArray[targetIndex] = objWEAP->attackDamage;
-							}
-						}
-					}
-				} else if(baseForm->IsArmor()) {
-					LogMessage("Item %s has baseFormID %08X", itemData->GetName(), baseForm->GetFormID());
-					TESObjectARMO* objARMO = DYNAMIC_CAST<TESObjectARMO*>(baseForm);
-
-					if(objARMO) {
-						LogMessage("Armor piece %s occupies slot mask %d", itemData->GetName(), objARMO->GetSlotMask());
-						if(objARMO->IsLightArmor()) {
-							if(objARMO->HasPartOf(BGSBipedObjectForm::kPart_Body)) {
-								// Armor
-								targetIndex = 0;
-							} else if(objARMO->HasPartOf(BGSBipedObjectForm::kPart_Feet)) {
-								// Boots
-								targetIndex = 1;
-							} else if(objARMO->HasPartOf(BGSBipedObjectForm::kPart_Hands)) {
-								// Gauntlets
-								targetIndex = 2;
-							} else if(objARMO->HasPartOf(BGSBipedObjectForm::kPart_Hair)) {
-								// Helmet
-								targetIndex = 3;
-							} else if(objARMO->HasPartOf(BGSBipedObjectForm::kPart_Shield)) {
-								// Shield
-								targetIndex = 4;
-							} else {
-								targetIndex = -1;
-							}
-						} else if(objARMO->IsHeavyArmor()) {
-							if(objARMO->HasPartOf(BGSBipedObjectForm::kPart_Body)) {
-								// Armor
-								targetIndex = 5;
-							} else if(objARMO->HasPartOf(BGSBipedObjectForm::kPart_Feet)) {
-								// Boots
-								targetIndex = 6;
-							} else if(objARMO->HasPartOf(BGSBipedObjectForm::kPart_Hands)) {
-								// Gauntlets
-								targetIndex = 7;
-							} else if(objARMO->HasPartOf(BGSBipedObjectForm::kPart_Hair)) {
-								// Helmet
-								targetIndex = 8;
-							} else if(objARMO->HasPartOf(BGSBipedObjectForm::kPart_Shield)) {
-								// Shield
-								targetIndex = 9;
-							} else {
-								targetIndex = -1;
-							}
-						} else {
-							if(objARMO->HasPartOf(BGSBipedObjectForm::kPart_Body)) {
-								// Body
-								targetIndex = 20;
-							} else if(objARMO->HasPartOf(BGSBipedObjectForm::kPart_Feet)) {
-								// Shoes
-								targetIndex = 21;
-							} else if(objARMO->HasPartOf(BGSBipedObjectForm::kPart_Hands)) {
-								// Gloves
-								targetIndex = 22;
-							} else if(objARMO->HasPartOf(BGSBipedObjectForm::kPart_Hair)) {
-								// Hat
-								targetIndex = 23;
-							} else {
-								targetIndex = -1;
-							}
-						}
-						if(targetIndex != -1) {
-							if(objARMO->armorValTimes100 > bestValueArray[targetIndex]) {
-								bestItemArray[targetIndex]	= itemData;
-								bestValueArray[targetIndex] = objARMO->armorValTimes100;
-							}
-						}
-					}
-				} else if(baseForm->IsAmmo()) {
-					LogMessage("Item %s has baseFormID %X", itemData->GetName(), baseForm->GetFormID());
-					TESAmmo* tesAMMO = DYNAMIC_CAST<TESAmmo*>(baseForm);
-
-					if(tesAMMO) {
-						if(!tesAMMO->isBolt()) {
-							targetIndex = 18;
-						} else {
-							targetIndex = 19;
-						}
-
-						if(targetIndex != -1) {
-							if(tesAMMO->settings.damage > bestValueArray[targetIndex]) {
-								bestItemArray[targetIndex]	= itemData;
-								bestValueArray[targetIndex] = tesAMMO->settings.damage;
-							}
-						}
-					}
+typedef SnapshotSlot<ConfigSnapshot>::Reader ConfigReader;
+
+static SnapshotSlot<ConfigSnapshot>		g_config;
+static std::mutex						g_reloadLock;
+static std::unique_ptr<const GameIndex>	g_gameIndex; // Set by OnDataLoaded, guarded by g_reloadLock
+static std::atomic<std::uint64_t>		g_rankedList(0);
+static PlayerBestIndex					g_playerBest;
+static PlayerBestIndex					g_equipped;
+static AlchemySolver					g_alchemy;
+static RuntimePotions					g_runtimePotions;
+
+static const UInt32 kLogFlushIntervalMs = 20;
+static const UInt32 kCompressedFlushMs	= 1000;
+
+// Only the log queue's flush thread touches them
+static SegmentedLog	 g_mappedLog;
+static LogCompressor g_logCompressor;
+static bool			 g_logCompressed = false;
+static std::int64_t	 g_pendingSince	 = 0; // steady_clock ms of the oldest line waiting in the block
+
+// Set at exit, the next flush writes out the block right away
+static std::atomic<bool> g_logClosing(false);
+
+/*
+PendingSnapshot
+The snapshot of a slow pass waiting for the log queue's flush thread, writing it on the UI
+thread would add to the stutter it records. One waits at a time, a slow pass finding one still
+there drops its own
+*/
+struct PendingSnapshot
+{
+	Plugin_BestInClassPP_Proc* proc;
+	Snapshot				   snapshot;
+	std::string				   directory;
+	UInt32					   maxSnapshots;
+	bool					   dumpTrace;
+	double					   totalMs;
+	float					   budgetMs;
+};
+
+static std::mutex						g_snapshotLock;
+static std::unique_ptr<PendingSnapshot>	g_pendingSnapshot; // Guarded by g_snapshotLock, written out by the log closer at exit
+
+static std::int64_t GetSteadyMs()
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Compresses the lines waiting in the block into a frame of the mapped log
+static void WriteCompressedBlock()
+{
+	const std::uint8_t* frame;
+	std::size_t			size = g_logCompressor.Finish(frame);
+	std::string			error;
+	if(size && g_mappedLog.IsOpen() && !g_mappedLog.Append(reinterpret_cast<const char*>(frame), size, error)) { _MESSAGE("ERROR: Could not write the mapped log, %s", error.c_str()); }
+}
+
+// Drains the log queue and ends the compressed block from the calling thread. When the flush
+// thread holds the queue nothing is written, at exit it was stopped midway. A crash does not
+// get here, lines already in the mapped log survive it and the block being compressed is lost
+static void CloseLog()
+{
+	g_logClosing.store(true);
+	LogQueue::GetSingleton()->TryFlush();
+}
+
+// Destroyed before the mapped log, at exit the flush thread is gone and the last lines are
+// written here. The log queue is created first, so it is still there to be drained
+static struct CompressedLogCloser
+{
+	CompressedLogCloser() { LogQueue::GetSingleton(); }
+	~CompressedLogCloser() { CloseLog(); }
+} g_compressedLogCloser;
+
+// Opens, reopens or closes the mapped log to match the settings, false when lines go to the
+// SKSE log
+static bool UpdateMappedLog(const ConfigSnapshot* config)
+{
+	if(!config || !config->settings.logMapped) {
+		WriteCompressedBlock();
+		g_mappedLog.Close();
+		return false;
+	}
+
+	const Settings& settings	= config->settings;
+	std::size_t		segmentSize = static_cast<std::size_t>(settings.logSegmentKB) * 1024;
+	std::string		header;
+	if(settings.logCompress) {
+		std::uint8_t streamHeader[kLogStreamHeaderSize];
+		LogCompressor::GetStreamHeader(streamHeader);
+		header.assign(reinterpret_cast<const char*>(streamHeader), sizeof(streamHeader));
+
+		// Room for a block that did not compress after the header
+		segmentSize = std::max<std::size_t>(segmentSize, 2 * LogCompressor::blockSize);
+	}
+	if(g_mappedLog.IsOpen() && g_mappedLog.GetPath() == settings.logMappedPath && g_mappedLog.GetSegmentSize() == segmentSize && g_mappedLog.GetRetention() == settings.logSegments && g_mappedLog.GetHeader() == header) { return true; }
+
+	// Lines compressed so far end the old file
+	WriteCompressedBlock();
+	g_mappedLog.SetHeader(header);
+	g_logCompressed = settings.logCompress;
+
+	std::string error;
+	if(!g_mappedLog.Open(settings.logMappedPath, segmentSize, settings.logSegments, error)) {
+		_MESSAGE("ERROR: Could not open the mapped log, %s", error.c_str());
+		return false;
+	}
+	return true;
+}
+
+// Runs on the log queue's flush thread, the only one writing the log file
+static void WriteLogRecord(const LogRecord& record)
+{
+	char message[1024];
+	std::memcpy(message, record.text, record.length);
+	message[record.length] = 0;
+
+	std::chrono::system_clock::time_point time{std::chrono::system_clock::duration(record.time)};
+	std::string							  date = date::format("%F %T", time);
+
+	ConfigReader reader(g_config);
+	if(UpdateMappedLog(reader.Get())) {
+		char		line[1152];
+		std::size_t length = FormatText(line, sizeof(line), BIC_FMT("[%s] %s\n"), date.c_str(), message);
+		if(g_logCompressed) {
+			if(!g_logCompressor.GetPending()) { g_pendingSince = GetSteadyMs(); }
+			if(g_logCompressor.Add(line, length)) { return; }
+
+			WriteCompressedBlock();
+			g_pendingSince = GetSteadyMs();
+			g_logCompressor.Add(line, length);
+			return;
+		}
+
+		std::string error;
+		if(g_mappedLog.Append(line, length, error)) { return; }
+
+		_MESSAGE("ERROR: Could not write the mapped log, %s", error.c_str());
+	}
+
+	_MESSAGE("[%s] %s", date.c_str(), message);
+}
+
+// A quiet log still reaches the file, lines wait in the block for a second at most
+static void FlushCompressedLog()
+{
+	if(g_logCompressor.GetPending() && (g_logClosing.load() || GetSteadyMs() - g_pendingSince >= kCompressedFlushMs)) { WriteCompressedBlock(); }
+}
+
+// Runs on the flush thread. The trace is dumped with the snapshot, so it may hold a few events
+// that came after the pass
+static void WritePendingSnapshot()
+{
+	std::unique_ptr<PendingSnapshot> pending;
+	{
+		std::lock_guard<std::mutex> guard(g_snapshotLock);
+		pending = std::move(g_pendingSnapshot);
+	}
+	if(!pending) { return; }
+
+	Plugin_BestInClassPP_Proc* proc		= pending->proc;
+	const Snapshot&			   snapshot = pending->snapshot;
+	UInt32					   numItems = static_cast<UInt32>(snapshot.items.size());
+
+	std::string path, error;
+	if(WriteRotatingSnapshot(pending->directory, pending->maxSnapshots, snapshot, path, error)) {
+		proc->LogMessage(BIC_FMT("WATCHDOG: Ranking %d items of %s took %.2f ms, over the budget of %.2f ms, wrote \"%s\""), numItems, snapshot.menu.c_str(), pending->totalMs, pending->budgetMs, path.c_str());
+
+		// The events leading up to the pass go next to its snapshot, slow_3.txt gets slow_3_trace.txt
+		std::string tracePath = path.substr(0, path.size() - 4) + "_trace.txt";
+		if(pending->dumpTrace && !FlightRecorder::GetSingleton()->Dump(tracePath.c_str(), "slow pass", error)) { proc->LogMessage(BIC_FMT("WATCHDOG: Could not dump the flight recorder, %s"), error.c_str()); }
+	} else {
+		proc->LogMessage(BIC_FMT("WATCHDOG: Ranking %d items of %s took %.2f ms, over the budget of %.2f ms, could not write a snapshot, %s"), numItems, snapshot.menu.c_str(), pending->totalMs, pending->budgetMs, error.c_str());
+	}
+}
+
+static void OnLogFlushed()
+{
+	FlushCompressedLog();
+	WritePendingSnapshot();
+}
+
+// Whichever thread logs first starts the flush thread, no thread waits on another after that
+static void StartLogQueue()
+{
+	static std::once_flag started;
+	std::call_once(started, [] { LogQueue::GetSingleton()->Start(kLogFlushIntervalMs, WriteLogRecord, OnLogFlushed); });
+}
+
+void Plugin_BestInClassPP_Proc::WriteLog(const char* message, UInt32 length)
+{
+	StartLogQueue();
+	LogQueue::GetSingleton()->Push(message, length);
+}
+
+void Plugin_BestInClassPP_Proc::WriteSuppressed(const char* format, UInt32 suppressed)
+{
+	char		message[1024];
+	std::size_t length = FormatText(message, sizeof(message), BIC_FMT("Suppressed %d messages like \"%s\", over the rate limit"), suppressed, format);
+	WriteLog(message, static_cast<UInt32>(length));
+}
+
+bool Plugin_BestInClassPP_Proc::IsVerbose()
+{
+	ConfigReader		  reader(g_config);
+	const ConfigSnapshot* config = reader.Get();
+	return !config || config->settings.verboseLogging;
+}
+
+bool Plugin_BestInClassPP_Proc::LoadConfig(const char* path)
+{
+	// Serializes reloads against each other, ProcessInventory never takes this lock
+	std::lock_guard<std::mutex> guard(g_reloadLock);
+
+	std::unique_ptr<ConfigSnapshot> snapshot(new ConfigSnapshot);
+	std::string						error;
+
+	IniFile ini;
+	if(!ini.Load(path, error)) { LogMessage(BIC_FMT("No usable configuration (%s), using the defaults"), error.c_str()); }
+	snapshot->settings.Read(ini);
+
+	const char* rulesPath = snapshot->settings.rulesPath.c_str();
+	const char* blobPath  = snapshot->settings.rulesBlobPath.c_str();
+	RuleTable&	table	  = snapshot->table;
+	bool		loaded	  = false;
+
+	std::ifstream file(rulesPath, std::ios::binary);
+	std::string	  text;
+	if(file) { text.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()); }
+
+	// A precompiled blob is used as is, as long as it was built from the current rule file
+	if(snapshot->rulesBlob.Open(blobPath)) {
+		const BlobHeader* header = nullptr;
+
+		if(!ReadRuleBlob(snapshot->rulesBlob.GetData(), snapshot->rulesBlob.GetSize(), table, header, error)) {
+			LogMessage(BIC_FMT("Ignoring the rule blob \"%s\", %s"), blobPath, error.c_str());
+		} else if(file && (header->sourceSize != text.size() || header->sourceHash != HashRuleSource(text.data(), text.size()))) {
+			LogMessage(BIC_FMT("Ignoring the rule blob \"%s\", it is older than \"%s\""), blobPath, rulesPath);
+		} else {
+			LogMessage(BIC_FMT("Mapped the precompiled rules from \"%s\""), blobPath);
+			snapshot->rulesSource = rulesPath;
+			snapshot->rulesHash	  = header->sourceHash;
+			loaded				  = true;
+		}
+
+		if(!loaded) { snapshot->rulesBlob.Close(); }
+	}
+
+	if(!loaded) {
+		if(file) {
+			loaded				  = snapshot->rules.Compile(text.c_str(), error);
+			snapshot->rulesSource = rulesPath;
+			snapshot->rulesHash	  = HashRuleSource(text.data(), text.size());
+			if(!loaded) { LogMessage(BIC_FMT("ERROR: Could not compile \"%s\", %s"), rulesPath, error.c_str()); }
+		} else {
+			LogMessage(BIC_FMT("No rule file found at \"%s\""), rulesPath);
+		}
+
+		if(!loaded) {
+			LogMessage(BIC_FMT("Using the built-in category rules"));
+			if(!snapshot->rules.Compile(RuleProgram::GetDefaultRules(), error)) {
+				LogMessage(BIC_FMT("ERROR: The built-in rules failed to compile, %s"), error.c_str());
+				return false;
+			}
+			snapshot->rulesSource = "(built-in)";
+			snapshot->rulesHash	  = HashRuleSource(RuleProgram::GetDefaultRules(), std::strlen(RuleProgram::GetDefaultRules()));
+		}
+
+		table = snapshot->rules.GetTable();
+	}
+
+	// Categories without weights in the INI keep ranking by their own metric
+	snapshot->weights.Reset(table);
+	for(UInt32 i = 0; i < table.numCategories; i++) {
+		std::string weights = ini.GetString("Weights", table.categories[i].name, "");
+		if(weights.empty()) { continue; }
+
+		if(snapshot->weights.SetWeights(i, weights.c_str(), error)) {
+			LogMessage(BIC_FMT("Category %s is ranked by %s"), table.categories[i].name, weights.c_str());
+		} else {
+			LogMessage(BIC_FMT("ERROR: Ignoring the weights of category %s, %s"), table.categories[i].name, error.c_str());
+		}
+	}
+
+	// Reloads run on the watcher thread, they build on what data load indexed on the game thread
+	snapshot->keywords.SetKeywords(table.keywordFormIDs, table.numKeywords);
+	if(g_gameIndex) {
+		snapshot->keywords.Resolve(g_gameIndex->keywords);
+		snapshot->potions	  = g_gameIndex->potions;
+		snapshot->ingredients = g_gameIndex->ingredients;
+	}
+
+	{
+		ConfigReader reader(g_config);
+		snapshot->generation = reader.Get() ? reader.Get()->generation + 1 : 1;
+	}
+
+	LogMessage(BIC_FMT("Loaded %d rules in %d categories using %d keywords"), table.numRows, table.numCategories, table.numKeywords);
+	for(UInt32 i = 0; i < table.numCategories; i++) { LogMessage(BIC_FMT("	Category %d: %s ranked by %s"), i, table.categories[i].name, RuleProgram::GetMetricName(table.categories[i].metric)); }
+	LogMessage(BIC_FMT("Publishing configuration generation %d"), snapshot->generation);
+
+	// The crash handler chains to the one installed before it, so it is installed only once
+	static bool crashDumpInstalled = false;
+	if(snapshot->settings.traceDumpOnCrash && !crashDumpInstalled) {
+		InstallCrashDump();
+		crashDumpInstalled = true;
+	}
+
+	LogSite::SetLimit(snapshot->settings.logRateBurst, snapshot->settings.logRatePerSec);
+	LogQueue::GetSingleton()->SetCollapseRepeats(snapshot->settings.logCollapse);
+
+	FlightRecorder* recorder = FlightRecorder::GetSingleton();
+	recorder->Configure(snapshot->settings.traceEnabled, snapshot->settings.traceDumpFile);
+	recorder->Trace(kTrace_ConfigPublished, 0, snapshot->generation);
+
+	g_config.Publish(std::move(snapshot));
+	return loaded;
+}
+
+void Plugin_BestInClassPP_Proc::OnDataLoaded(const char* configPath)
+{
+	// The forms only exist now, they are indexed here on the game thread and the snapshot is rebuilt with them
+	std::unique_ptr<GameIndex> index(new GameIndex);
+	index->keywords.Build();
+	index->potions.Resolve();
+	index->ingredients.Resolve();
+	{
+		std::lock_guard<std::mutex> guard(g_reloadLock);
+		g_gameIndex = std::move(index);
+	}
+	LoadConfig(configPath);
+
+	ConfigReader		  reader(g_config);
+	const ConfigSnapshot* config = reader.Get();
+	if(config) {
+		LogMessage(BIC_FMT("Indexed %d keywords across %d forms"), config->keywords.GetNumKeywords(), config->keywords.GetNumForms());
+		LogMessage(BIC_FMT("Indexed %d potions across %d primary effects"), config->potions.GetNumPotions(), config->potions.GetNumEffects());
+		LogMessage(BIC_FMT("Indexed %d ingredients across %d effects"), config->ingredients.GetNumIngredients(), config->ingredients.GetNumEffects());
+	}
+}
+
+void Plugin_BestInClassPP_Proc::WatchConfig(const char* configPath)
+{
+	ConfigReader		  reader(g_config);
+	const ConfigSnapshot* config = reader.Get();
+	if(!config || !config->settings.watchFiles) { return; }
+
+	// Lives as long as the game, its thread is torn down with the process. The configuration's
+	// own path is the first one watched, a later call may move it
+	static FileWatcher* watcher = new FileWatcher();
+
+	watcher->SetPaths({configPath, config->settings.rulesPath, config->settings.rulesBlobPath, config->settings.traceTrigger});
+	watcher->Start(config->settings.pollIntervalMs, [this] {
+		std::string path = watcher->GetPath(0);
+		{
+			ConfigReader		  reader(g_config);
+			const ConfigSnapshot* current = reader.Get();
+
+			// Creating the trigger file asks for a dump of the flight recorder, the configuration stays
+			if(std::ifstream(current->settings.traceTrigger)) {
+				std::string error;
+				if(FlightRecorder::GetSingleton()->Dump("request", error)) {
+					LogMessage(BIC_FMT("Dumped the flight recorder to \"%s\""), current->settings.traceDumpFile.c_str());
+				} else {
+					LogMessage(BIC_FMT("ERROR: Could not dump the flight recorder, %s"), error.c_str());
 				}
+				std::remove(current->settings.traceTrigger.c_str());
+				watcher->SetPaths({path, current->settings.rulesPath, current->settings.rulesBlobPath, current->settings.traceTrigger});
+				return;
 			}
 		}
+
+		// A reader held over the reload would keep the retired snapshots from being freed
+		LogMessage(BIC_FMT("Configuration changed on disk, reloading"));
+		LoadConfig(path.c_str());
+
+		ConfigReader		  reloaded(g_config);
+		const ConfigSnapshot* config = reloaded.Get();
+		watcher->SetPaths({path, config->settings.rulesPath, config->settings.rulesBlobPath, config->settings.traceTrigger});
+	});
+
+	LogMessage(BIC_FMT("Watching \"%s\" and \"%s\" for changes"), configPath, config->settings.rulesPath.c_str());
+}
+
+/*
+ItemRecord
+The part of an item the ranking works on. Gathering them up front keeps the classify and
+rank loops off the item -> objDesc -> baseForm pointer chain
+*/
+struct ItemRecord
+{
+	TESForm* form;
+	UInt32	 index;
+	int		 category;
+	float	 score;
+};
+
+static_assert(sizeof(void*) != 4 || sizeof(ItemRecord) == 16, "ItemRecord should stay at 16 bytes");
+
+/*
+HashItemList
+Identifies a list by its item pointers and the configuration it was ranked with. Only the
+pointer array is read, the items themselves stay cold. 0 is reserved for no list
+*/
+static std::uint64_t HashItemList(BSTArray<StandardItemData*>& itemDataArray, std::uint32_t generation)
+{
+	std::uint64_t hash = 14695981039346656037ull ^ generation;
+	for(StandardItemData* itemData : itemDataArray) {
+		hash ^= reinterpret_cast<std::uintptr_t>(itemData);
+		hash *= 1099511628211ull;
+	}
+	hash ^= itemDataArray.size();
+	hash *= 1099511628211ull;
+	return hash ? hash : 1;
+}
+
+bool Plugin_BestInClassPP_Proc::WasRanked(BSTArray<StandardItemData*>& itemDataArray)
+{
+	ConfigReader		  reader(g_config);
+	const ConfigSnapshot* config = reader.Get();
+	if(!config || !config->settings.skipRankedLists) { return false; }
+
+	return g_rankedList.load() == HashItemList(itemDataArray, config->generation);
+}
+
+void Plugin_BestInClassPP_Proc::ForgetRankedList()
+{
+	g_rankedList.store(0);
+}
+
+// Potion categories come after the rule categories and have no player or equipped scores
+static bool IsRuleCategory(const RuleTable& rules, int category)
+{
+	return category != -1 && static_cast<UInt32>(category) < rules.numCategories;
+}
+
+static const char* GetRankedBy(const RuleTable& rules, int category)
+{
+	return IsRuleCategory(rules, category) ? RuleProgram::GetMetricName(rules.categories[category].metric) : "magnitude x duration";
+}
+
+// A piece covering several slots occupies all of them, a hooded robe keeps both a cuirass and a
+// helmet out of the loadout
+static UInt32 GetLoadoutSlots(UInt32 slotMask)
+{
+	UInt32 slots = 0;
+	if(slotMask & BGSBipedObjectForm::kPart_Body) { slots |= LoadoutSlotBit(kLoadout_Body); }
+	if(slotMask & BGSBipedObjectForm::kPart_Feet) { slots |= LoadoutSlotBit(kLoadout_Feet); }
+	if(slotMask & BGSBipedObjectForm::kPart_Hands) { slots |= LoadoutSlotBit(kLoadout_Hands); }
+	if(slotMask & (BGSBipedObjectForm::kPart_Head | BGSBipedObjectForm::kPart_Hair)) { slots |= LoadoutSlotBit(kLoadout_Head); }
+	if(slotMask & BGSBipedObjectForm::kPart_Shield) { slots |= LoadoutSlotBit(kLoadout_Shield); }
+	return slots;
+}
+
+// Enchanting at the arcane enchanter adds ExtraEnchantment to the inventory entry, the base form
+// stays unenchanted. Returns the extra list carrying it, null for an unenchanted entry
+static BaseExtraList* FindPlayerEnchantment(InventoryEntryData* objDesc)
+{
+	if(!objDesc->extendDataList) { return nullptr; }
+	for(BaseExtraList* extraList : *objDesc->extendDataList) {
+		if(extraList && extraList->HasType(kExtraData_Enchantment)) { return extraList; }
+	}
+	return nullptr;
+}
+
+/*
+SkseItemPolicy
+Reads the ranking engine's records from the game forms. GetKind sorts out the form type once,
+the other accessors are only asked for records of the matching kind
+*/
+struct SkseItemPolicy
+{
+	typedef ItemRecord Record;
+
+	Plugin_BestInClassPP_Proc*	 proc;
+	const ConfigSnapshot*		 config;
+	BSTArray<StandardItemData*>* itemDataArray; // Null for forms outside of a list
+
+	// Whether a form outside of a list stands for a player enchanted copy
+	bool playerEnchanted = false;
+
+	// Filled in by OnGroup when set
+	LoadoutItem*	   loadoutItems	   = nullptr;
+	UInt32			   numLoadoutItems = 0;
+	const Ingredient** ingredients	   = nullptr;
+	UInt32			   numIngredients  = 0;
+
+	// Shadow passes read the same items again, only the authoritative pass logs them
+	bool verbose = true;
+
+	// Heap allocations of the runtime potion cache, which fills as brewed potions are first seen
+	std::size_t potionAllocations = 0;
+
+	SkseItemPolicy(Plugin_BestInClassPP_Proc* proc, const ConfigSnapshot* config, BSTArray<StandardItemData*>* itemDataArray) : proc(proc), config(config), itemDataArray(itemDataArray) {}
+
+	template<class Format, class... Args>
+	void LogVerbose(Format format, const Args&... args)
+	{
+		if(verbose) { proc->LogVerbose(format, args...); }
+	}
+
+	const char* GetName(const Record& record) { return itemDataArray ? (*itemDataArray)[record.index]->GetName() : "(player inventory)"; }
+
+	// Only weapons and armor can be enchanted, other forms never look at their extra data
+	bool IsPlayerEnchanted(const Record& record)
+	{
+		if(record.form->formType != kFormType_Weapon && record.form->formType != kFormType_Armor) { return false; }
+		return itemDataArray ? FindPlayerEnchantment((*itemDataArray)[record.index]->objDesc) != nullptr : playerEnchanted;
+	}
+
+	// A player enchanted entry is ranked on its own, the other entries of its form are not enchanted
+	const void* GetKey(const Record& record) { return itemDataArray && IsPlayerEnchanted(record) ? static_cast<const void*>((*itemDataArray)[record.index]->objDesc) : record.form; }
+
+	// Load order potions are scored at data load and brewed ones when first seen, both skip the rules
+	bool GetPresetScore(const Record& record, int& category, float& score)
+	{
+		UInt32 effect;
+		if(!config->settings.rankPotions || record.form->formType != kFormType_Potion) { return false; }
+		if(!config->potions.GetPotion(record.form, effect, score)) {
+			AllocationScope caching;
+			bool			found = g_runtimePotions.GetPotion(config->generation, config->potions, record.form, effect, score);
+			potionAllocations += caching.GetCount();
+			if(!found) { return false; }
+		}
+
+		category = config->table.numCategories + effect;
+		return true;
+	}
+
+	ItemKind GetKind(const Record& record)
+	{
+		ItemKind kind;
+		switch(record.form->formType) {
+			case kFormType_Weapon: kind = kKind_Weapon; break;
+			case kFormType_Armor: kind = kKind_Armor; break;
+			case kFormType_Ammo: kind = kKind_Ammo; break;
+			default: return kKind_None;
+		}
+
+		LogVerbose(BIC_FMT("Item %s has baseFormID %08X"), GetName(record), record.form->GetFormID());
+		return kind;
+	}
+
+	WeaponKind GetWeaponType(const Record& record)
+	{
+		TESObjectWEAP* objWEAP = FormCast<TESObjectWEAP>(record.form);
+		LogVerbose(BIC_FMT("Weapon %s has type %d"), GetName(record), objWEAP->gameData.type);
+		switch(objWEAP->type()) {
+			case TESObjectWEAP::GameData::kType_1HS:
+			case TESObjectWEAP::GameData::kType_OneHandSword: return kWeapon_Sword;
+			case TESObjectWEAP::GameData::kType_1HD:
+			case TESObjectWEAP::GameData::kType_OneHandDagger: return kWeapon_Dagger;
+			case TESObjectWEAP::GameData::kType_1HA:
+			case TESObjectWEAP::GameData::kType_OneHandAxe: return kWeapon_WarAxe;
+			case TESObjectWEAP::GameData::kType_1HM:
+			case TESObjectWEAP::GameData::kType_OneHandMace: return kWeapon_Mace;
+			case TESObjectWEAP::GameData::kType_2HS:
+			case TESObjectWEAP::GameData::kType_TwoHandSword: return kWeapon_Greatsword;
+			case TESObjectWEAP::GameData::kType_2HA:
+			case TESObjectWEAP::GameData::kType_TwoHandAxe: return kWeapon_Battleaxe;
+			case TESObjectWEAP::GameData::kType_Bow2:
+			case TESObjectWEAP::GameData::kType_Bow: return kWeapon_Bow;
+			case TESObjectWEAP::GameData::kType_CBow:
+			case TESObjectWEAP::GameData::kType_CrossBow: return kWeapon_Crossbow;
+			case TESObjectWEAP::GameData::kType_Staff2:
+			case TESObjectWEAP::GameData::kType_Staff: return kWeapon_Staff;
+			case TESObjectWEAP::GameData::kType_H2H:
+			case TESObjectWEAP::GameData::kType_HandToHandMelee: return kWeapon_HandToHand;
+			default: return kWeapon_None;
+		}
+	}
+
+	ArmorKind GetArmorType(const Record& record)
+	{
+		TESObjectARMO* objARMO = FormCast<TESObjectARMO>(record.form);
+		if(objARMO->IsLightArmor()) { return kArmor_Light; }
+		if(objARMO->IsHeavyArmor()) { return kArmor_Heavy; }
+		return kArmor_Clothing;
+	}
+
+	UInt32 GetSlotMask(const Record& record)
+	{
+		UInt32 slotMask = FormCast<TESObjectARMO>(record.form)->GetSlotMask();
+		LogVerbose(BIC_FMT("Armor piece %s occupies slot mask %d"), GetName(record), slotMask);
+		return slotMask;
+	}
+
+	UInt8 GetFlags(const Record& record, ItemKind kind)
+	{
+		switch(kind) {
+			case kKind_Weapon: return FormCast<TESObjectWEAP>(record.form)->enchantment || IsPlayerEnchanted(record) ? kItemFlag_Enchanted : 0;
+			case kKind_Armor: return FormCast<TESObjectARMO>(record.form)->enchantment || IsPlayerEnchanted(record) ? kItemFlag_Enchanted : 0;
+			case kKind_Ammo: return FormCast<TESAmmo>(record.form)->isBolt() ? kItemFlag_Bolt : 0;
+			default: return 0;
+		}
+	}
+
+	void GetMetrics(const Record& record, ItemKind kind, float* metrics)
+	{
+		if(kind == kKind_Weapon) {
+			TESObjectWEAP* objWEAP	= FormCast<TESObjectWEAP>(record.form);
+			metrics[kMetric_Damage]	= objWEAP->attackDamage;
+			metrics[kMetric_Weight]	= objWEAP->weight;
+			metrics[kMetric_Value]	= static_cast<float>(objWEAP->value);
+			metrics[kMetric_Speed]	= objWEAP->gameData.speed;
+		} else if(kind == kKind_Armor) {
+			TESObjectARMO* objARMO	= FormCast<TESObjectARMO>(record.form);
+			metrics[kMetric_Armor]	= objARMO->armorValTimes100 / 100.0f;
+			metrics[kMetric_Weight]	= objARMO->weight;
+			metrics[kMetric_Value]	= static_cast<float>(objARMO->value);
+		} else if(kind == kKind_Ammo) {
+			TESAmmo* tesAMMO		= FormCast<TESAmmo>(record.form);
+			metrics[kMetric_Damage]	= tesAMMO->settings.damage;
+			metrics[kMetric_Value]	= static_cast<float>(tesAMMO->value);
+		}
+	}
+
+	KeywordSet GetKeywords(const Record& record) { return config->keywords.GetKeywords(record.form); }
+
+	void OnGroup(const Record& record, const ItemFacts* facts, int category)
+	{
+		if(ingredients && record.form->formType == kFormType_Ingredient) {
+			const Ingredient* ingredient = config->ingredients.GetIngredient(record.form);
+			if(ingredient) { ingredients[numIngredients++] = ingredient; }
+		}
+		if(loadoutItems && facts && category != -1 && facts->kind == kKind_Armor) { loadoutItems[numLoadoutItems++] = {record.index, GetLoadoutSlots(facts->slotMask), facts->metrics[kMetric_Weight], facts->metrics[kMetric_Armor]}; }
+	}
+
+	void OnCompare(const Record& best, const Record& record) { proc->LogVerbose(BIC_FMT("		Last Item: %s with %.1f %s"), GetName(best), best.score, GetRankedBy(config->table, record.category)); }
+};
+
+/*
+BuildSnapshot
+Captures the list as the ranking engines see it, the facts are gathered again from the forms.
+shadowRecords is null when no shadow pass ran
+*/
+static void BuildSnapshot(SkseItemPolicy& policy, const ItemRecord* records, const ItemRecord* shadowRecords, UInt32 numRecords, UInt32 numCategories, Snapshot& snapshot)
+{
+	const ConfigSnapshot* config = policy.config;
+
+	snapshot.rulesPath		   = config->rulesSource;
+	snapshot.rulesHash		   = config->rulesHash;
+	snapshot.generation		   = config->generation;
+	snapshot.numCategories	   = numCategories;
+	snapshot.numRuleCategories = config->table.numCategories;
+	for(UInt32 c = 0; c < config->table.numCategories; c++) { snapshot.weights.insert(snapshot.weights.end(), config->weights.GetWeights(c), config->weights.GetWeights(c) + kMetric_Count); }
+	snapshot.items.resize(numRecords);
+
+	for(UInt32 i = 0; i < numRecords; i++) {
+		SnapshotItem& item = snapshot.items[i];
+
+		item.formID			= records[i].form->GetFormID();
+		item.presetCategory	= -1;
+		item.presetScore	= 0.0f;
+		item.category		= records[i].category;
+		item.score			= records[i].score;
+		item.shadowCategory	= shadowRecords ? shadowRecords[i].category : -1;
+		item.shadowScore	= shadowRecords ? shadowRecords[i].score : 0.0f;
+		item.name			= policy.GetName(records[i]);
+		if(!policy.GetPresetScore(records[i], item.presetCategory, item.presetScore)) { RankingEngine<SkseItemPolicy>::GatherFacts(policy, records[i], item.facts); }
+	}
+}
+
+// The engine shadow mode checks RankingEngine against, swap in the implementation under test
+typedef ReferenceRankingEngine<SkseItemPolicy> ShadowEngine;
+
+static const char* GetRecordName(BSTArray<StandardItemData*>& itemDataArray, const ItemRecord* records, std::int32_t index)
+{
+	return index == -1 ? "(none)" : itemDataArray[records[index].index]->GetName();
+}
+
+/*
+RunShadowPass
+Ranks the list again with the ShadowEngine on a copy of the records and compares the best item
+of every category with the authoritative pass, whose results are the only ones shown. A
+mismatch is logged and dumps a snapshot of the list. Returns the heap allocations made, those
+are left out of the pass's audit
+*/
+static std::size_t RunShadowPass(Plugin_BestInClassPP_Proc* proc, Arena& arena, const ConfigSnapshot* config, BSTArray<StandardItemData*>& itemDataArray, const ItemRecord* records, UInt32 numRecords, UInt32 numCategories, const std::int32_t* best, double rankMicroseconds)
+{
+	AllocationScope allocations;
+
+	ItemRecord*	  shadowRecords	= arena.AllocateArray<ItemRecord>(numRecords);
+	std::int32_t* shadowBest	= arena.AllocateArray<std::int32_t>(numCategories);
+	std::memcpy(shadowRecords, records, numRecords * sizeof(ItemRecord));
+
+	SkseItemPolicy policy(proc, config, &itemDataArray);
+	policy.verbose = false;
+
+	auto start = std::chrono::steady_clock::now();
+	ShadowEngine(config->table, config->weights).Rank(policy, shadowRecords, numRecords, numCategories, shadowBest);
+	double shadowMicroseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+	UInt32 numMismatches = 0;
+	for(UInt32 c = 0; c < numCategories; c++) {
+		if(best[c] == shadowBest[c] && (best[c] == -1 || records[best[c]].score == shadowRecords[best[c]].score)) { continue; }
+
+		float score		  = best[c] == -1 ? 0.0f : records[best[c]].score;
+		float shadowScore = shadowBest[c] == -1 ? 0.0f : shadowRecords[shadowBest[c]].score;
+		FlightRecorder::GetSingleton()->Trace(kTrace_ShadowMismatch, best[c] == -1 ? 0 : records[best[c]].form->GetFormID(), c, score);
+		proc->LogMessage(BIC_FMT("Shadow mismatch in category %d, the engine picked %s (%f) and the candidate %s (%f)"), c, GetRecordName(itemDataArray, records, best[c]), score, GetRecordName(itemDataArray, shadowRecords, shadowBest[c]), shadowScore);
+		numMismatches++;
+	}
+
+	proc->LogVerbose(BIC_FMT("Shadow pass over %d items took %.1f us against %.1f us, %d of %d categories differ"), numRecords, shadowMicroseconds, rankMicroseconds, numMismatches, numCategories);
+	if(!numMismatches) { return allocations.GetCount(); }
+
+	Snapshot snapshot;
+	BuildSnapshot(policy, records, shadowRecords, numRecords, numCategories, snapshot);
+	snapshot.reason = "shadow mismatch";
+
+	std::string error;
+	if(WriteSnapshot(config->settings.shadowSnapshot.c_str(), snapshot, error)) {
+		proc->LogMessage(BIC_FMT("Wrote a snapshot of the list to \"%s\""), config->settings.shadowSnapshot.c_str());
+	} else {
+		proc->LogMessage(BIC_FMT("ERROR: Could not write the shadow snapshot, %s"), error.c_str());
+	}
+	return allocations.GetCount();
+}
+
+void Plugin_BestInClassPP_Proc::ProcessInventory(BSTArray<StandardItemData*>& itemDataArray, UInt32 listFlags, const char* menuName)
+{
+	PassTimings timings;
+
+	// Per-pass containers live in the arena, it is rewound when the pass returns
+	ArenaScope		scratch(arena);
+	AllocationScope allocations;
+	std::size_t		arenaBlocks = arena.GetBlockAllocations();
+
+	LogVerbose(BIC_FMT("The itemDataArray is at address %p"), &itemDataArray);
+
+	// One reader per pass, a reload publishing meanwhile only affects the next pass
+	ConfigReader		  reader(g_config);
+	const ConfigSnapshot* config = reader.Get();
+	if(!config) { return; }
+
+	const RuleTable& rules	  = config->table;
+	FlightRecorder*	 recorder = FlightRecorder::GetSingleton();
+	recorder->Trace(kTrace_PassBegin, 0, listFlags, static_cast<float>(itemDataArray.size()));
+
+	// One category per primary potion effect follows the categories of the rules, then room for
+	// the effects only brewed potions have
+	UInt32 numCategories = rules.numCategories + (config->settings.rankPotions ? config->potions.GetNumEffects() + RuntimePotions::maxEffects : 0);
+
+	ItemRecord* records	   = arena.AllocateArray<ItemRecord>(itemDataArray.size());
+	UInt32		numRecords = GatherRecords(itemDataArray, records, config->settings.prefetchDistance);
+	timings.Mark("gather");
+
+	SkseItemPolicy policy(this, config, &itemDataArray);
+
+	// Armor pieces the player carries are the candidates for the best loadout
+	if(config->settings.loadoutEnabled && (listFlags & kList_PlayerInventory)) { policy.loadoutItems = arena.AllocateArray<LoadoutItem>(numRecords); }
+
+	// Ingredient kinds the player carries, for the strongest potion they can brew
+	if(config->settings.suggestAlchemy && (listFlags & kList_PlayerInventory)) { policy.ingredients = arena.AllocateArray<const Ingredient*>(numRecords); }
+
+	std::int32_t*				  best = arena.AllocateArray<std::int32_t>(numCategories);
+	RankingEngine<SkseItemPolicy> engine(arena, rules, config->weights);
+	engine.Rank(policy, records, numRecords, numCategories, best);
+
+	// Every ranked item, so a dump shows what each pass decided and not only its winners
+	if(recorder->IsEnabled()) {
+		for(UInt32 i = 0; i < numRecords; i++) {
+			if(records[i].category != -1) { recorder->Trace(kTrace_ItemRanked, records[i].form->GetFormID(), records[i].category, records[i].score); }
+		}
+	}
+	timings.Mark("rank");
+
+	std::size_t shadowAllocations = 0;
+	if(config->settings.shadowEnabled) {
+		shadowAllocations = RunShadowPass(this, arena, config, itemDataArray, records, numRecords, numCategories, best, timings.GetLastPhaseMs() * 1000.0);
+		timings.Mark("shadow");
 	}
 
 	// By setting the member "bestInClass" to true,
 	// we tell the UI to mark the item
-	for(StandardItemData* itemData : bestItemArray) {
-		if(itemData) {
-			LogMessage("The best item of type is %s", itemData->GetName());
+	for(UInt32 i = 0; i < numCategories; i++) {
+		if(best[i] == -1) { continue; }
+
+		const ItemRecord& record   = records[best[i]];
+		StandardItemData* itemData = itemDataArray[record.index];
+		recorder->Trace(kTrace_BestItem, record.form->GetFormID(), i, record.score);
+		if(i < rules.numCategories) {
+			LogVerbose(BIC_FMT("The best item of type %s is %s"), rules.categories[i].name, itemData->GetName());
+		} else {
+			UInt32 effect	= i - rules.numCategories;
+			UInt32 effectID = effect < config->potions.GetNumEffects() ? config->potions.GetEffectFormID(effect) : g_runtimePotions.GetEffectFormID(effect - config->potions.GetNumEffects());
+			LogVerbose(BIC_FMT("The best potion with effect %08X is %s"), effectID, itemData->GetName());
+		}
+
+		LogVerbose(BIC_FMT("The itemData is at address %p"), &itemData);
+		LogVerbose(BIC_FMT("The fxValue is at address %p"), &itemData->fxValue);
+		itemData->fxValue.SetMember("bestInClass", true);
+	}
+	timings.Mark("mark");
+
+	// Marks the set with the highest armor rating that stays within the weight budget
+	if(policy.numLoadoutItems) {
+		UInt32 chosen[kLoadout_NumSlots];
+		float  armorRating;
+		UInt32 numChosen = SolveLoadout(arena, policy.loadoutItems, policy.numLoadoutItems, config->settings.loadoutMaxWeight, config->settings.loadoutWeightStep, chosen, armorRating);
+
+		LogVerbose(BIC_FMT("The best loadout within a weight of %.1f has %d pieces with an armor rating of %.1f"), config->settings.loadoutMaxWeight, numChosen, armorRating);
+		for(UInt32 i = 0; i < numChosen; i++) {
+			recorder->Trace(kTrace_LoadoutPiece, itemDataArray[chosen[i]]->objDesc->baseForm->GetFormID(), -1, armorRating);
+			itemDataArray[chosen[i]]->fxValue.SetMember("inLoadout", true);
+		}
+		timings.Mark("loadout");
+	}
+
+	// Marks the two or three ingredients brewing the strongest potion
+	if(policy.numIngredients) {
+		AlchemyResult alchemy = g_alchemy.Solve(arena, policy.ingredients, policy.numIngredients, config->generation);
+
+		LogVerbose(BIC_FMT("The strongest potion from %d ingredient kinds uses %d of them with a strength of %.1f"), policy.numIngredients, alchemy.numIngredients, alchemy.score);
+		for(UInt32 p = 0; p < alchemy.numIngredients; p++) { recorder->Trace(kTrace_AlchemyPart, alchemy.formIDs[p], -1, alchemy.score); }
+		for(UInt32 i = 0; i < numRecords; i++) {
+			UInt32 formID = records[i].form->GetFormID();
+			for(UInt32 p = 0; p < alchemy.numIngredients; p++) {
+				if(alchemy.formIDs[p] == formID) { itemDataArray[records[i].index]->fxValue.SetMember("bestAlchemy", true); }
+			}
+		}
+		timings.Mark("alchemy");
+	}
+
+	// The equipped scores only change with equip events, seeding is needed once per configuration
+	std::size_t seedAllocations = 0;
+	if((listFlags & kList_PlayerInventory) && !g_equipped.IsCurrent(config->generation)) {
+		AllocationScope seeding;
 
-			LogMessage("The itemData is at address %08X", &itemData);
-			LogMessage("The fxValue is at address %08X", &itemData->fxValue);
-			itemData->fxValue.SetMember("bestInClass", true);
+		g_equipped.Reset(config->generation, rules.numCategories);
+		for(UInt32 i = 0; i < numRecords; i++) {
+			const ItemRecord&	record	= records[i];
+			InventoryEntryData* objDesc = itemDataArray[record.index]->objDesc;
+			if(record.category != -1 && objDesc->IsWorn()) { g_equipped.Add(config->generation, record.form->GetFormID(), FindPlayerEnchantment(objDesc), record.category, record.score, 1); }
 		}
+		seedAllocations = seeding.GetCount();
+	}
+
+	// Any menu can compare with the player's items, the first pass after a reload reads them from
+	// the player's inventory changes. The inventory's own pass seeds the index from its list
+	if(!(listFlags & kList_PlayerInventory) && !g_playerBest.IsCurrent(config->generation)) {
+		AllocationScope seeding;
+		SeedPlayerBest(config);
+		seedAllocations += seeding.GetCount();
+		timings.Mark("seed");
 	}
 
-	LogMessage("The bestItemArray is at address %08X", &bestItemArray);
-	LogMessage("Finished marking the best items");
+	// One subtraction per item, the equipped scores are copied once per pass. Nothing equipped in
+	// a category leaves its items without a delta, scores can be negative so 0 is no baseline
+	if(config->settings.showEquippedDelta) {
+		float* equippedScores = arena.AllocateArray<float>(rules.numCategories);
+		if(g_equipped.GetBestScores(config->generation, equippedScores, rules.numCategories)) {
+			for(UInt32 i = 0; i < numRecords; i++) {
+				const ItemRecord& record = records[i];
+				if(IsRuleCategory(rules, record.category) && equippedScores[record.category] != -FLT_MAX) { itemDataArray[record.index]->fxValue.SetMember("equippedDelta", static_cast<double>(record.score - equippedScores[record.category])); }
+			}
+		}
+	}
+
+	// Items of a container or merchant beating the best the player owns in their category, any
+	// item is an upgrade in a category the player owns nothing of
+	if(listFlags & kList_CompareWithPlayer) {
+		float* playerBest = arena.AllocateArray<float>(rules.numCategories);
+		if(g_playerBest.GetBestScores(config->generation, playerBest, rules.numCategories)) {
+			for(UInt32 i = 0; i < numRecords; i++) {
+				const ItemRecord& record = records[i];
+				if(!IsRuleCategory(rules, record.category) || record.score <= playerBest[record.category]) { continue; }
+
+				recorder->Trace(kTrace_Upgrade, record.form->GetFormID(), record.category, record.score);
+				itemDataArray[record.index]->fxValue.SetMember("isUpgrade", true);
+			}
+		} else {
+			LogVerbose(BIC_FMT("The player's items have not been indexed with this configuration yet"));
+		}
+	}
+
+	timings.Mark("compare");
+
+	LogVerbose(BIC_FMT("The best items are at address %p"), best);
+	LogVerbose(BIC_FMT("Finished marking the best items"));
+
+	g_rankedList.store(HashItemList(itemDataArray, config->generation));
+
+	// The arena growing is expected until the largest inventory has been seen, as are seeding the
+	// player indexes, caching brewed potions and shadow mode, anything else is a heap allocation on the menu path. Text
+	// logging allocates, so only quiet passes count
+	std::size_t passAllocations = allocations.GetCount() - (arena.GetBlockAllocations() - arenaBlocks) - seedAllocations - shadowAllocations - policy.potionAllocations;
+	if(passAllocations && !config->settings.verboseLogging) {
+		LogMessage(BIC_FMT("ERROR: Processing the inventory performed %d heap allocations"), passAllocations);
+		assert(!"ProcessInventory allocated outside of the arena");
+	}
+	timings.Mark("finish");
+
+	// The player index keeps heap storage of its own, so it is seeded after the audit
+	if(listFlags & kList_PlayerInventory) {
+		g_playerBest.Reset(config->generation, rules.numCategories);
+		for(UInt32 i = 0; i < numRecords; i++) {
+			const ItemRecord&	record	= records[i];
+			InventoryEntryData* objDesc = itemDataArray[record.index]->objDesc;
+			if(record.category != -1) { g_playerBest.Add(config->generation, record.form->GetFormID(), FindPlayerEnchantment(objDesc), record.category, record.score, std::max(1, objDesc->countDelta)); }
+		}
+		timings.Mark("seed");
+	}
+	recorder->Trace(kTrace_PassEnd, 0, listFlags, timings.GetTotalMs());
+
+	// A pass over the budget leaves a snapshot of its list, the cause of a stutter can be looked at
+	// offline with tools/replay.cpp
+	float budgetMs = config->settings.watchdogBudgetMs;
+	if(budgetMs > 0.0f && timings.GetTotalMs() > budgetMs) {
+		recorder->Trace(kTrace_SlowPass, 0, listFlags, timings.GetTotalMs());
+
+		SkseItemPolicy quiet(this, config, &itemDataArray);
+		quiet.verbose = false;
+
+		// The list is read here, the forms and the menu's items are not for other threads
+		std::unique_ptr<PendingSnapshot> pending(new PendingSnapshot);
+		Snapshot&						 snapshot = pending->snapshot;
+		BuildSnapshot(quiet, records, nullptr, numRecords, numCategories, snapshot);
+		snapshot.reason = "slow pass";
+		snapshot.menu	= menuName;
+		for(UInt32 i = 0; i < timings.GetNumPhases(); i++) { snapshot.timings.push_back({timings.GetPhase(i), timings.GetPhaseMs(i)}); }
+		snapshot.timings.push_back({"total", timings.GetTotalMs()});
+
+		pending->proc		  = this;
+		pending->directory	  = config->settings.snapshotDirectory;
+		pending->maxSnapshots = config->settings.maxSnapshots;
+		pending->dumpTrace	  = config->settings.traceEnabled;
+		pending->totalMs	  = timings.GetTotalMs();
+		pending->budgetMs	  = budgetMs;
+
+		bool handedOff = false;
+		{
+			std::lock_guard<std::mutex> guard(g_snapshotLock);
+			if(!g_pendingSnapshot) {
+				g_pendingSnapshot = std::move(pending);
+				handedOff		  = true;
+			}
+		}
+
+		if(handedOff) {
+			StartLogQueue();
+		} else {
+			LogMessage(BIC_FMT("WATCHDOG: Ranking %d items of %s took %.2f ms, over the budget of %.2f ms, the last snapshot is still being written"), numRecords, menuName, timings.GetTotalMs(), budgetMs);
+		}
+	}
 };
+
+bool Plugin_BestInClassPP_Proc::ClassifyForm(const ConfigSnapshot* config, TESForm* form, bool playerEnchanted, int& category, float& score)
+{
+	if(!form) { return false; }
+
+	SkseItemPolicy policy(this, config, nullptr);
+	policy.playerEnchanted = playerEnchanted;
+	ItemRecord	   record = {form, 0, -1, 0.0f};
+	ItemFacts	   facts;
+	if(!RankingEngine<SkseItemPolicy>::GatherFacts(policy, record, facts)) { return false; }
+
+	category = config->table.Classify(facts);
+	if(category == -1) { return false; }
+
+	score = config->weights.Score(facts, category);
+	return true;
+}
+
+/*
+SeedPlayerBest
+Fills the player index from the player's inventory changes, the player's base container holds
+nothing worth comparing. Every player enchanted extra list is a copy of its own, the rest of
+the entry's count are plain copies
+*/
+void Plugin_BestInClassPP_Proc::SeedPlayerBest(const ConfigSnapshot* config)
+{
+	g_playerBest.Reset(config->generation, config->table.numCategories);
+
+	PlayerCharacter*	   player  = PlayerCharacter::GetSingleton();
+	ExtraContainerChanges* changes = player ? static_cast<ExtraContainerChanges*>(player->extraData.GetByType(kExtraData_ContainerChanges)) : nullptr;
+	if(!changes || !changes->data || !changes->data->objList) { return; }
+
+	int	  category;
+	float score;
+	for(InventoryEntryData* objDesc : *changes->data->objList) {
+		if(!objDesc || !objDesc->baseForm || objDesc->countDelta <= 0) { continue; }
+
+		SInt32 numPlain = objDesc->countDelta;
+		if(objDesc->extendDataList) {
+			for(BaseExtraList* extraList : *objDesc->extendDataList) {
+				if(!extraList || !extraList->HasType(kExtraData_Enchantment)) { continue; }
+				if(ClassifyForm(config, objDesc->baseForm, true, category, score)) { g_playerBest.Add(config->generation, objDesc->baseForm->GetFormID(), extraList, category, score, 1); }
+				numPlain--;
+			}
+		}
+		if(numPlain > 0 && ClassifyForm(config, objDesc->baseForm, false, category, score)) { g_playerBest.Add(config->generation, objDesc->baseForm->GetFormID(), nullptr, category, score, numPlain); }
+	}
+}
+
+void Plugin_BestInClassPP_Proc::OnPlayerItemChanged(UInt32 formID, SInt32 count)
+{
+	FlightRecorder::GetSingleton()->Trace(count < 0 ? kTrace_ItemRemoved : kTrace_ItemAdded, formID, -1, static_cast<float>(count < 0 ? -count : count));
+
+	// Until the inventory has been ranked with the current configuration there is nothing to update
+	ConfigReader		  reader(g_config);
+	const ConfigSnapshot* config = reader.Get();
+	if(!config || !g_playerBest.IsCurrent(config->generation)) { return; }
+
+	if(count < 0) {
+		g_playerBest.Remove(config->generation, formID, -count);
+		return;
+	}
+
+	int	  category;
+	float score;
+	if(ClassifyForm(config, LookupFormByID(formID), false, category, score)) { g_playerBest.Add(config->generation, formID, nullptr, category, score, count); }
+}
+
+void Plugin_BestInClassPP_Proc::OnPlayerEquipChanged(UInt32 formID, bool equipped)
+{
+	FlightRecorder::GetSingleton()->Trace(equipped ? kTrace_Equipped : kTrace_Unequipped, formID);
+
+	ConfigReader		  reader(g_config);
+	const ConfigSnapshot* config = reader.Get();
+	if(!config || !g_equipped.IsCurrent(config->generation)) { return; }
+
+	if(!equipped) {
+		g_equipped.Remove(config->generation, formID, 1);
+		return;
+	}
+
+	int	  category;
+	float score;
+	if(ClassifyForm(config, LookupFormByID(formID), false, category, score)) { g_equipped.Add(config->generation, formID, nullptr, category, score, 1); }
+}
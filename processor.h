@@ -12,19 +12,90 @@
 #include <SKSE/GameReferences.h>
 
 #include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <string>
 #include <vector>
 
+#include "alchemy.h"
+#include "allocaudit.h"
+#include "arena.h"
+#include "blob.h"
+#include "config.h"
 #include "date.h"
+#include "flightrecorder.h"
+#include "format.h"
+#include "formdispatch.h"
+#include "gather.h"
+#include "itemgroups.h"
+#include "keywords.h"
+#include "loadout.h"
+#include "logcompress.h"
+#include "logqueue.h"
+#include "playerbest.h"
+#include "ranking.h"
+#include "rules.h"
+#include "segmentedlog.h"
+#include "snapshot.h"
+#include "watchdog.h"
+
+// What a list holds, decides what a pass does besides marking the best items
+enum ItemListFlags : UInt32
+{
+	kList_PlayerInventory	= 1 << 0, // Seeds the index of the player's best items from the list
+	kList_CompareWithPlayer = 1 << 1  // Marks items beating the player's best as upgrades
+};
 
 class Plugin_BestInClassPP_Proc
 {
 	public:
-	void LogMessage(const char* fmt, ...);
-	void ProcessInventory(BSTArray<StandardItemData*>& itemDataArray);
+	// The format goes through BIC_FMT and is checked against the arguments while compiling. Each
+	// format is rate limited on its own, a suppressed message is never formatted
+	template<class Format, class... Args>
+	void LogMessage(Format, const Args&... args)
+	{
+		BIC_CHECK_FORMAT(Format, Args);
+
+		static LogSite site;
+		UInt32		   suppressed;
+		if(!site.Allow(suppressed)) { return; }
+		if(suppressed) { WriteSuppressed(Format::Get(), suppressed); }
+
+		char		message[1024];
+		std::size_t length = FormatTo(message, sizeof(message), Format::Get(), args...);
+		WriteLog(message, static_cast<UInt32>(length));
+	}
+
+	template<class Format, class... Args>
+	void LogVerbose(Format format, const Args&... args)
+	{
+		if(IsVerbose()) { LogMessage(format, args...); }
+	}
+
+	void ProcessInventory(BSTArray<StandardItemData*>& itemDataArray, UInt32 listFlags, const char* menuName);
+
+	// True when the list is the one the last pass ranked and nothing changed since
+	bool WasRanked(BSTArray<StandardItemData*>& itemDataArray);
+	void ForgetRankedList();
+
+	bool LoadConfig(const char* path);
+	void OnDataLoaded(const char* configPath);
+	void WatchConfig(const char* configPath);
+
+	// Keeps the player's best items current between inventory passes, negative counts remove
+	void OnPlayerItemChanged(UInt32 formID, SInt32 count);
+	void OnPlayerEquipChanged(UInt32 formID, bool equipped);
 
 	private:
-	static const int  arraySize = 23;
-	StandardItemData* bestItemArray[arraySize];
-	float			  bestValueArray[arraySize];
+	void WriteLog(const char* message, UInt32 length);
+	void WriteSuppressed(const char* format, UInt32 suppressed);
+	bool IsVerbose();
+	bool ClassifyForm(const ConfigSnapshot* config, TESForm* form, bool playerEnchanted, int& category, float& score);
+	void SeedPlayerBest(const ConfigSnapshot* config);
+
+	Arena arena;
 };
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <cstdint>
+
+#include "arena.h"
+#include "itemgroups.h"
+#include "keywords.h"
+#include "rules.h"
+#include "scoring.h"
+
+/*
+RankingEngine
+Classifies, scores and ranks one list of items. The engine never touches a game type, it reads
+the items through a policy and everything it calls is inline, so it costs nothing over
+reading the forms directly. The policy provides
+
+	typedef ... Record;	with int category and float score, filled in by the engine
+
+	const void*	  GetKey(const Record&)				records sharing a key share their result
+	bool		  GetPresetScore(const Record&, int& category, float& score)
+	ItemKind	  GetKind(const Record&)			kKind_None leaves the record unclassified
+	WeaponKind	  GetWeaponType(const Record&)		only asked for weapons
+	ArmorKind	  GetArmorType(const Record&)		only asked for armor
+	std::uint32_t GetSlotMask(const Record&)		only asked for armor
+	std::uint8_t  GetFlags(const Record&, ItemKind)
+	void		  GetMetrics(const Record&, ItemKind, float* metrics)
+	KeywordSet	  GetKeywords(const Record&)
+	void		  OnGroup(const Record&, const ItemFacts* facts, int category)
+	void		  OnCompare(const Record& best, const Record& record)
+
+OnGroup sees the first record of every key, with null facts when none were gathered, and
+OnCompare every record about to be compared to the best of its category so far.
+
+Preset scores skip the rules and the weights, that is how potions are ranked
+*/
+template<class Policy>
+class RankingEngine
+{
+	public:
+	typedef typename Policy::Record Record;
+
+	RankingEngine(Arena& arena, const RuleTable& rules, const ScoreWeights& weights) : arena(arena), rules(rules), weights(weights) {}
+
+	// Sets the category and score of every record, best[c] is the index of the best record of
+	// category c or -1. Scratch memory comes from the arena and lives until its scope ends
+	void Rank(Policy& policy, Record* records, std::uint32_t count, std::uint32_t numCategories, std::int32_t* best) const
+	{
+		ItemGroups groups(arena, count);
+
+		for(std::uint32_t i = 0; i < count; i++) {
+			Record& record = records[i];
+
+			// Only the first record of a key is classified and scored, the others reuse its result.
+			// Scoring right away beats filling score columns for ScoreColumns, see tools/scorebench.cpp
+			bool			   added;
+			ItemGroups::Group& group = groups.Find(policy.GetKey(record), added);
+			if(added) {
+				ItemFacts facts;
+				bool	  preset   = policy.GetPresetScore(record, group.category, group.score);
+				bool	  gathered = !preset && GatherFacts(policy, record, facts);
+				if(gathered) { group.category = rules.Classify(facts); }
+				if(gathered && group.category != -1) { group.score = weights.Score(facts, group.category); }
+				policy.OnGroup(record, gathered ? &facts : nullptr, group.category);
+			}
+
+			record.category = group.category;
+			record.score	= group.score;
+		}
+
+		// The first of equally scored records stays the best
+		for(std::uint32_t c = 0; c < numCategories; c++) { best[c] = -1; }
+		for(std::uint32_t i = 0; i < count; i++) {
+			const Record& record   = records[i];
+			int			  category = record.category;
+			if(category == -1 || static_cast<std::uint32_t>(category) >= numCategories) { continue; }
+
+			// Scores may be zero or negative, the first record of a category is its best so far
+			if(best[category] == -1) {
+				best[category] = static_cast<std::int32_t>(i);
+				continue;
+			}
+
+			policy.OnCompare(records[best[category]], record);
+			if(record.score > records[best[category]].score) { best[category] = static_cast<std::int32_t>(i); }
+		}
+	}
+
+	// Fills the facts a rule tests, false for records that are not weapons, armor or ammo
+	static bool GatherFacts(Policy& policy, const Record& record, ItemFacts& facts)
+	{
+		ItemKind kind = policy.GetKind(record);
+		if(kind == kKind_None) { return false; }
+
+		facts.kind = kind;
+		if(kind == kKind_Weapon) { facts.weaponType = policy.GetWeaponType(record); }
+		if(kind == kKind_Armor) {
+			facts.armorType = policy.GetArmorType(record);
+			facts.slotMask	= policy.GetSlotMask(record);
+		}
+		facts.flags = policy.GetFlags(record, kind);
+		policy.GetMetrics(record, kind, facts.metrics);
+		facts.keywords = policy.GetKeywords(record);
+		return true;
+	}
+
+	private:
+	Arena&				arena;
+	const RuleTable&	rules;
+	const ScoreWeights& weights;
+};
+
+/*
+ReferenceRankingEngine
+Ranks the plain way, every record is classified and scored on its own through
+ScoreWeights::Score and there is no grouping and no scratch memory. Slow but easy to trust,
+shadow mode checks RankingEngine against it
+*/
+template<class Policy>
+class ReferenceRankingEngine
+{
+	public:
+	typedef typename Policy::Record Record;
+
+	ReferenceRankingEngine(const RuleTable& rules, const ScoreWeights& weights) : rules(rules), weights(weights) {}
+
+	void Rank(Policy& policy, Record* records, std::uint32_t count, std::uint32_t numCategories, std::int32_t* best) const
+	{
+		for(std::uint32_t i = 0; i < count; i++) {
+			Record& record = records[i];
+
+			record.category = -1;
+			record.score	= 0.0f;
+			if(policy.GetPresetScore(record, record.category, record.score)) { continue; }
+
+			ItemFacts facts;
+			if(!RankingEngine<Policy>::GatherFacts(policy, record, facts)) { continue; }
+
+			record.category = rules.Classify(facts);
+			if(record.category != -1) { record.score = weights.Score(facts, record.category); }
+		}
+
+		for(std::uint32_t c = 0; c < numCategories; c++) { best[c] = -1; }
+		for(std::uint32_t i = 0; i < count; i++) {
+			int category = records[i].category;
+			if(category == -1 || static_cast<std::uint32_t>(category) >= numCategories) { continue; }
+
+			if(best[category] == -1 || records[i].score > records[best[category]].score) { best[category] = static_cast<std::int32_t>(i); }
+		}
+	}
+
+	private:
+	const RuleTable&	rules;
+	const ScoreWeights& weights;
+};
+
+/*
+PlainItemPolicy
+Ranks plain structs instead of game forms, so the engine builds and runs with nothing but the
+standard library. Records pointing to the same PlainItem share their result like items of one
+base form do
+*/
+struct PlainItem
+{
+	ItemKind	  kind		 = kKind_None;
+	WeaponKind	  weaponType = kWeapon_None;
+	ArmorKind	  armorType	 = kArmor_None;
+	std::uint8_t  flags		 = 0;
+	std::uint32_t slotMask	 = 0;
+	float		  metrics[kMetric_Count] = {};
+	KeywordSet	  keywords;
+};
+
+struct PlainItemPolicy
+{
+	struct Record
+	{
+		const PlainItem* item;
+		int				 category;
+		float			 score;
+	};
+
+	const void*	  GetKey(const Record& record) { return record.item; }
+	bool		  GetPresetScore(const Record&, int&, float&) { return false; }
+	ItemKind	  GetKind(const Record& record) { return record.item->kind; }
+	WeaponKind	  GetWeaponType(const Record& record) { return record.item->weaponType; }
+	ArmorKind	  GetArmorType(const Record& record) { return record.item->armorType; }
+	std::uint32_t GetSlotMask(const Record& record) { return record.item->slotMask; }
+	std::uint8_t  GetFlags(const Record& record, ItemKind) { return record.item->flags; }
+	KeywordSet	  GetKeywords(const Record& record) { return record.item->keywords; }
+
+	void GetMetrics(const Record& record, ItemKind, float* metrics)
+	{
+		for(std::uint32_t m = 0; m < kMetric_Count; m++) metrics[m] = record.item->metrics[m];
+	}
+
+	void OnGroup(const Record&, const ItemFacts*, int) {}
+	void OnCompare(const Record&, const Record&) {}
+};
@@ -0,0 +1,406 @@
+#include "rules.h"
+
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+/*
+Built-in rules, used when no rule file is present
+The declaration order gives the category indices documented in processor.cpp
+*/
+static const char* defaultRules = R"(
+category LightArmor by armor
+category LightBoots by armor
+category LightGauntlets by armor
+category LightHelmet by armor
+category LightShield by armor
+category HeavyArmor by armor
+category HeavyBoots by armor
+category HeavyGauntlets by armor
+category HeavyHelmet by armor
+category HeavyShield by armor
+category 1HSword by damage
+category 1HWarAxe by damage
+category 1HMace by damage
+category 1HDagger by damage
+category 2HGreatsword by damage
+category 2HBattleaxe by damage
+category Bow by damage
+category Crossbow by damage
+category Arrow by damage
+category Bolt by damage
+category ClothingBody by armor
+category ClothingShoes by armor
+category ClothingGloves by armor
+category ClothingHat by armor
+
+# Vanilla keywords from Skyrim.esm, so modded items tagged with them land in the same categories
+rule LightArmor: armor keyword 0x0006BBD3 keyword 0x0006C0EC
+rule LightBoots: armor keyword 0x0006BBD3 keyword 0x0006C0ED
+rule LightGauntlets: armor keyword 0x0006BBD3 keyword 0x0006C0EF
+rule LightHelmet: armor keyword 0x0006BBD3 keyword 0x0006C0EE
+rule LightShield: armor keyword 0x0006BBD3 keyword 0x000965B2
+rule HeavyArmor: armor keyword 0x0006BBD2 keyword 0x0006C0EC
+rule HeavyBoots: armor keyword 0x0006BBD2 keyword 0x0006C0ED
+rule HeavyGauntlets: armor keyword 0x0006BBD2 keyword 0x0006C0EF
+rule HeavyHelmet: armor keyword 0x0006BBD2 keyword 0x0006C0EE
+rule HeavyShield: armor keyword 0x0006BBD2 keyword 0x000965B2
+rule 1HSword: weapon keyword 0x0001E711
+rule 1HWarAxe: weapon keyword 0x0001E712
+rule 1HMace: weapon keyword 0x0001E714
+rule 1HDagger: weapon keyword 0x0001E713
+rule 2HGreatsword: weapon keyword 0x0006D931
+rule 2HBattleaxe: weapon keyword 0x0006D932
+rule 2HBattleaxe: weapon keyword 0x0006D930
+# Dawnguard crossbows carry WeapTypeBow, their weapon type decides first
+rule Crossbow: crossbow
+rule Bow: weapon keyword 0x0001E715
+
+# Fallback on the form data itself
+rule LightArmor: light body
+rule LightBoots: light feet
+rule LightGauntlets: light hands
+rule LightHelmet: light helmet
+rule LightShield: light shield
+rule HeavyArmor: heavy body
+rule HeavyBoots: heavy feet
+rule HeavyGauntlets: heavy hands
+rule HeavyHelmet: heavy helmet
+rule HeavyShield: heavy shield
+rule ClothingBody: clothing body
+rule ClothingShoes: clothing feet
+rule ClothingGloves: clothing hands
+rule ClothingHat: clothing helmet
+rule 1HSword: sword
+rule 1HWarAxe: waraxe
+rule 1HMace: mace
+rule 1HDagger: dagger
+rule 2HGreatsword: greatsword
+rule 2HBattleaxe: battleaxe
+rule Bow: bow
+rule Arrow: arrow
+rule Bolt: bolt
+)";
+
+static const char* metricNames[kMetric_Count] = {"damage", "armor", "weight", "value", "speed"};
+
+// Biped slot bits as used by BGSBipedObjectForm
+static const std::uint32_t slotHelmet = 1 << 1;
+static const std::uint32_t slotBody	  = 1 << 2;
+static const std::uint32_t slotHands  = 1 << 3;
+static const std::uint32_t slotFeet	  = 1 << 7;
+static const std::uint32_t slotShield = 1 << 9;
+
+struct NamedValue
+{
+	const char*	  name;
+	std::uint32_t value;
+};
+
+static const NamedValue weaponNames[] = {{"sword", kWeapon_Sword},
+										 {"dagger", kWeapon_Dagger},
+										 {"waraxe", kWeapon_WarAxe},
+										 {"mace", kWeapon_Mace},
+										 {"greatsword", kWeapon_Greatsword},
+										 {"battleaxe", kWeapon_Battleaxe},
+										 {"bow", kWeapon_Bow},
+										 {"crossbow", kWeapon_Crossbow},
+										 {"staff", kWeapon_Staff},
+										 {"handtohand", kWeapon_HandToHand}};
+
+static const NamedValue armorNames[] = {{"light", kArmor_Light}, {"heavy", kArmor_Heavy}, {"clothing", kArmor_Clothing}};
+
+static const NamedValue slotNames[] = {{"body", slotBody}, {"hands", slotHands}, {"feet", slotFeet}, {"helmet", slotHelmet}, {"shield", slotShield}};
+
+template<std::size_t N>
+static bool FindNamed(const NamedValue (&table)[N], const std::string& name, std::uint32_t& value)
+{
+	for(const NamedValue& entry : table) {
+		if(name == entry.name) {
+			value = entry.value;
+			return true;
+		}
+	}
+	return false;
+}
+
+static int FindMetric(const std::string& name)
+{
+	for(int m = 0; m < kMetric_Count; m++) {
+		if(name == metricNames[m]) { return m; }
+	}
+	return -1;
+}
+
+/*
+Tokenizer
+Splits a single line into words, numbers, "strings" and the operators : < <= > >=
+*/
+struct Token
+{
+	enum Type
+	{
+		kWord,
+		kNumber,
+		kString,
+		kSymbol
+	};
+
+	Type		type;
+	std::string text;
+};
+
+static bool Tokenize(const std::string& line, std::vector<Token>& tokens, std::string& error)
+{
+	tokens.clear();
+
+	std::size_t i = 0;
+	while(i < line.size()) {
+		char c = line[i];
+
+		if(c == '#') { break; }
+		if(std::isspace(static_cast<unsigned char>(c))) {
+			i++;
+			continue;
+		}
+
+		std::size_t start = i;
+		if(c == '"') {
+			std::size_t end = line.find('"', i + 1);
+			if(end == std::string::npos) {
+				error = "unterminated string";
+				return false;
+			}
+			tokens.push_back({Token::kString, line.substr(i + 1, end - i - 1)});
+			i = end + 1;
+		} else if(c == ':') {
+			tokens.push_back({Token::kSymbol, ":"});
+			i++;
+		} else if(c == '<' || c == '>') {
+			i += (i + 1 < line.size() && line[i + 1] == '=') ? 2 : 1;
+			tokens.push_back({Token::kSymbol, line.substr(start, i - start)});
+		} else if(std::isdigit(static_cast<unsigned char>(c)) || c == '-' || c == '.') {
+			// Category names may start with a digit (1HSword), so numbers are only what strtod/strtoul fully consume
+			while(i < line.size() && (std::isalnum(static_cast<unsigned char>(line[i])) || line[i] == '_' || line[i] == '.' || line[i] == '-')) i++;
+			std::string text = line.substr(start, i - start);
+			char*		end	 = nullptr;
+			if(text.compare(0, 2, "0x") == 0 || text.compare(0, 2, "0X") == 0) {
+				std::strtoul(text.c_str(), &end, 16);
+			} else {
+				std::strtod(text.c_str(), &end);
+			}
+			tokens.push_back({*end == '\0' ? Token::kNumber : Token::kWord, text});
+		} else if(std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+			while(i < line.size() && (std::isalnum(static_cast<unsigned char>(line[i])) || line[i] == '_')) i++;
+			tokens.push_back({Token::kWord, line.substr(start, i - start)});
+		} else {
+			error = std::string("unexpected character '") + c + "'";
+			return false;
+		}
+	}
+
+	return true;
+}
+
+int RuleProgram::FindCategory(const std::string& name) const
+{
+	for(std::size_t i = 0; i < categories.size(); i++) {
+		if(name == categories[i].name) { return static_cast<int>(i); }
+	}
+	return -1;
+}
+
+int RuleProgram::AssignKeywordBit(std::uint32_t formID)
+{
+	for(std::size_t bit = 0; bit < keywordFormIDs.size(); bit++) {
+		if(keywordFormIDs[bit] == formID) { return static_cast<int>(bit); }
+	}
+
+	if(keywordFormIDs.size() >= KeywordSet::maxBits) { return -1; }
+
+	keywordFormIDs.push_back(formID);
+	return static_cast<int>(keywordFormIDs.size() - 1);
+}
+
+bool RuleProgram::Compile(const char* text, std::string& error)
+{
+	rows.clear();
+	kindRows.clear();
+	kindStart.clear();
+	categories.clear();
+	keywordFormIDs.clear();
+
+	std::vector<Token> tokens;
+	std::string		   line;
+	int				   lineNumber = 0;
+
+	auto fail = [&](const std::string& reason) {
+		error = "line " + std::to_string(lineNumber) + ": " + reason;
+		rows.clear();
+		kindRows.clear();
+		kindStart.clear();
+		categories.clear();
+		keywordFormIDs.clear();
+		return false;
+	};
+
+	const char* cursor = text;
+	while(*cursor) {
+		const char* lineEnd = std::strchr(cursor, '\n');
+		if(!lineEnd) { lineEnd = cursor + std::strlen(cursor); }
+		line.assign(cursor, lineEnd);
+		cursor = *lineEnd ? lineEnd + 1 : lineEnd;
+		lineNumber++;
+
+		std::string tokenError;
+		if(!Tokenize(line, tokens, tokenError)) { return fail(tokenError); }
+		if(tokens.empty()) { continue; }
+
+		const Token& head = tokens[0];
+		if(head.type != Token::kWord) { return fail("expected 'category' or 'rule'"); }
+
+		if(head.text == "category") {
+			// category <name> by <metric>
+			if(tokens.size() != 4 || tokens[1].type == Token::kSymbol || tokens[2].text != "by") { return fail("expected 'category <name> by <metric>'"); }
+			if(tokens[1].text.size() > CategoryDef::maxNameLength) { return fail("category name is too long"); }
+			if(FindCategory(tokens[1].text) != -1) { return fail("category '" + tokens[1].text + "' is declared twice"); }
+
+			int metric = FindMetric(tokens[3].text);
+			if(metric == -1) { return fail("unknown metric '" + tokens[3].text + "'"); }
+
+			CategoryDef def = {};
+			std::memcpy(def.name, tokens[1].text.c_str(), tokens[1].text.size());
+			def.metric = static_cast<std::uint8_t>(metric);
+			categories.push_back(def);
+		} else if(head.text == "rule") {
+			// rule <name>: <condition>...
+			if(tokens.size() < 3 || tokens[1].type == Token::kSymbol || tokens[2].text != ":") { return fail("expected 'rule <name>: <conditions>'"); }
+
+			int category = FindCategory(tokens[1].text);
+			if(category == -1) { return fail("unknown category '" + tokens[1].text + "'"); }
+
+			RuleRow row = {};
+			row.category = category;
+			for(int m = 0; m < kMetric_Count; m++) {
+				row.lower[m] = std::numeric_limits<float>::lowest();
+				row.upper[m] = std::numeric_limits<float>::max();
+			}
+
+			for(std::size_t t = 3; t < tokens.size(); t++) {
+				bool negate = false;
+				if(tokens[t].text == "not") {
+					negate = true;
+					if(++t == tokens.size()) { return fail("'not' needs a condition"); }
+				}
+
+				const std::string& word = tokens[t].text;
+				std::uint32_t	   value;
+				int				   metric;
+
+				if(word == "keyword") {
+					if(++t == tokens.size() || tokens[t].type != Token::kNumber) { return fail("'keyword' needs a FormID"); }
+					int bit = AssignKeywordBit(static_cast<std::uint32_t>(std::strtoul(tokens[t].text.c_str(), nullptr, 0)));
+					if(bit == -1) { return fail("too many distinct keywords"); }
+					(negate ? row.excluded : row.required).Set(bit);
+				} else if(word == "enchanted") {
+					(negate ? row.flagsClear : row.flagsSet) |= kItemFlag_Enchanted;
+				} else if(negate) {
+					return fail("'" + word + "' cannot be negated");
+				} else if(word == "weapon") {
+					row.kindMask |= 1u << kKind_Weapon;
+				} else if(word == "armor") {
+					row.kindMask |= 1u << kKind_Armor;
+				} else if(word == "ammo") {
+					row.kindMask |= 1u << kKind_Ammo;
+				} else if(word == "arrow" || word == "bolt") {
+					row.kindMask |= 1u << kKind_Ammo;
+					(word == "bolt" ? row.flagsSet : row.flagsClear) |= kItemFlag_Bolt;
+					if(row.flagsSet & row.flagsClear & kItemFlag_Bolt) { return fail("'arrow' and 'bolt' are exclusive"); }
+				} else if(FindNamed(weaponNames, word, value)) {
+					row.kindMask |= 1u << kKind_Weapon;
+					row.weaponTypeMask |= 1u << value;
+				} else if(FindNamed(armorNames, word, value)) {
+					row.kindMask |= 1u << kKind_Armor;
+					row.armorTypeMask |= 1u << value;
+				} else if(FindNamed(slotNames, word, value)) {
+					row.kindMask |= 1u << kKind_Armor;
+					row.slotMask |= value;
+				} else if(word == "slot") {
+					if(++t == tokens.size() || tokens[t].type != Token::kNumber) { return fail("'slot' needs a biped slot number"); }
+					int slot = std::atoi(tokens[t].text.c_str());
+					if(slot < 30 || slot > 61) { return fail("biped slots range from 30 to 61"); }
+					row.kindMask |= 1u << kKind_Armor;
+					row.slotMask |= 1u << (slot - 30);
+				} else if((metric = FindMetric(word)) != -1) {
+					if(t + 2 >= tokens.size() || tokens[t + 1].type != Token::kSymbol || tokens[t + 2].type != Token::kNumber) { return fail("expected '" + word + " <op> <number>'"); }
+					const std::string& op	 = tokens[t + 1].text;
+					float			   bound = static_cast<float>(std::strtod(tokens[t + 2].text.c_str(), nullptr));
+					t += 2;
+
+					if(op == "<") {
+						row.upper[metric] = std::fmin(row.upper[metric], std::nextafter(bound, std::numeric_limits<float>::lowest()));
+					} else if(op == "<=") {
+						row.upper[metric] = std::fmin(row.upper[metric], bound);
+					} else if(op == ">") {
+						row.lower[metric] = std::fmax(row.lower[metric], std::nextafter(bound, std::numeric_limits<float>::max()));
+					} else if(op == ">=") {
+						row.lower[metric] = std::fmax(row.lower[metric], bound);
+					} else {
+						return fail("unknown comparison '" + op + "'");
+					}
+					row.hasBounds = 1;
+				} else {
+					return fail("unknown condition '" + word + "'");
+				}
+			}
+
+			// An empty group means any value is accepted
+			if(!row.kindMask) { row.kindMask = ~0u; }
+			if(!row.weaponTypeMask) { row.weaponTypeMask = ~0u; }
+			if(!row.armorTypeMask) { row.armorTypeMask = ~0u; }
+
+			rows.push_back(row);
+		} else {
+			return fail("expected 'category' or 'rule', got '" + head.text + "'");
+		}
+	}
+
+	if(categories.empty()) { return fail("no categories declared"); }
+
+	// Every kind's rows in declaration order, so the first match stays the same
+	for(std::uint32_t kind = 0; kind < RuleTable::numKinds; kind++) {
+		kindStart.push_back(static_cast<std::uint32_t>(kindRows.size()));
+		for(const RuleRow& row : rows) {
+			if(row.kindMask & (1u << kind)) { kindRows.push_back(row); }
+		}
+	}
+	kindStart.push_back(static_cast<std::uint32_t>(kindRows.size()));
+
+	return true;
+}
+
+RuleTable RuleProgram::GetTable() const
+{
+	RuleTable table;
+	table.rows			 = rows.data();
+	table.numRows		 = static_cast<std::uint32_t>(rows.size());
+	table.kindRows		 = kindRows.data();
+	table.kindStart		 = kindStart.empty() ? nullptr : kindStart.data();
+	table.categories	 = categories.data();
+	table.numCategories	 = static_cast<std::uint32_t>(categories.size());
+	table.keywordFormIDs = keywordFormIDs.data();
+	table.numKeywords	 = static_cast<std::uint32_t>(keywordFormIDs.size());
+	return table;
+}
+
+const char* RuleProgram::GetDefaultRules()
+{
+	return defaultRules;
+}
+
+const char* RuleProgram::GetMetricName(std::uint8_t metric)
+{
+	return metric < kMetric_Count ? metricNames[metric] : "unknown";
+}
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "keywords.h"
+
+/*
+Category Rules
+Categories and the rules sorting items into them are written in a small line based language
+and compiled into a flat decision table at startup. Every rule is one row of bit masks and
+bounds, a row matches when all of its tests pass and the first matching row wins.
+
+	# comment
+	category <name> by <damage|armor|weight|value|speed>
+	rule <name>: <condition> <condition> ...
+
+Conditions of the same kind are OR'ed, different kinds are AND'ed
+	weapon armor ammo							form type
+	sword dagger waraxe mace greatsword
+	battleaxe bow crossbow staff handtohand		weapon type (implies weapon)
+	light heavy clothing						armor type (implies armor)
+	body hands feet helmet shield, slot <30-61>	biped slots (implies armor)
+	arrow bolt									ammo type (implies ammo)
+	enchanted, not enchanted
+	keyword <FormID>, not keyword <FormID>		every listed keyword is required / excluded
+	<metric> <|<=|>|>= <number>					e.g. weight < 5
+
+Names are identifiers or "quoted strings", categories are numbered in declaration order.
+*/
+
+enum ItemKind : std::uint8_t
+{
+	kKind_None,
+	kKind_Weapon,
+	kKind_Armor,
+	kKind_Ammo
+};
+
+enum WeaponKind : std::uint8_t
+{
+	kWeapon_None,
+	kWeapon_Sword,
+	kWeapon_Dagger,
+	kWeapon_WarAxe,
+	kWeapon_Mace,
+	kWeapon_Greatsword,
+	kWeapon_Battleaxe,
+	kWeapon_Bow,
+	kWeapon_Crossbow,
+	kWeapon_Staff,
+	kWeapon_HandToHand
+};
+
+enum ArmorKind : std::uint8_t
+{
+	kArmor_None,
+	kArmor_Light,
+	kArmor_Heavy,
+	kArmor_Clothing
+};
+
+enum ItemFlags : std::uint8_t
+{
+	kItemFlag_Enchanted = 1 << 0,
+	kItemFlag_Bolt		= 1 << 1
+};
+
+enum Metric : std::uint8_t
+{
+	kMetric_Damage,
+	kMetric_Armor,
+	kMetric_Weight,
+	kMetric_Value,
+	kMetric_Speed,
+	kMetric_Count
+};
+
+// Everything a rule can test, gathered once per item from the game form
+struct ItemFacts
+{
+	ItemKind	  kind		 = kKind_None;
+	WeaponKind	  weaponType = kWeapon_None;
+	ArmorKind	  armorType	 = kArmor_None;
+	std::uint8_t  flags		 = 0;
+	std::uint32_t slotMask	 = 0;
+	float		  metrics[kMetric_Count] = {};
+	KeywordSet	  keywords;
+};
+
+struct RuleRow
+{
+	std::uint32_t kindMask;
+	std::uint32_t weaponTypeMask;
+	std::uint32_t armorTypeMask;
+	std::uint32_t slotMask;
+	std::uint8_t  flagsSet;
+	std::uint8_t  flagsClear;
+	std::uint8_t  hasBounds;
+	std::uint8_t  pad;
+	std::uint32_t category;
+	KeywordSet	  required;
+	KeywordSet	  excluded;
+	float		  lower[kMetric_Count];
+	float		  upper[kMetric_Count];
+};
+
+struct CategoryDef
+{
+	static const std::uint32_t maxNameLength = 47;
+
+	char		 name[maxNameLength + 1];
+	std::uint8_t metric;
+	std::uint8_t pad[3];
+};
+
+/*
+RuleTable
+Non-owning view of a compiled program, this is what the per-item evaluation runs on. rows are
+the rules as declared. kindRows holds them again split by the item kind they can match, in
+declaration order within each kind, rows kindStart[k] up to kindStart[k + 1] are those of kind
+k. A rule matching several kinds is in each of their ranges
+*/
+struct RuleTable
+{
+	static const std::uint32_t numKinds = kKind_Ammo + 1;
+
+	const RuleRow*		 rows			= nullptr;
+	std::uint32_t		 numRows		= 0;
+	const RuleRow*		 kindRows		= nullptr;
+	const std::uint32_t* kindStart		= nullptr; // numKinds + 1 entries
+	const CategoryDef*	 categories		= nullptr;
+	std::uint32_t		 numCategories	= 0;
+	const std::uint32_t* keywordFormIDs = nullptr;
+	std::uint32_t		 numKeywords	= 0;
+
+	// Returns the category of the first matching row or -1, only the rows of the item's kind
+	// are tried
+	int Classify(const ItemFacts& facts) const
+	{
+		if(!kindStart || facts.kind >= numKinds) { return -1; }
+
+		const std::uint32_t weaponBit = 1u << facts.weaponType;
+		const std::uint32_t armorBit  = 1u << facts.armorType;
+		const std::uint32_t end		  = kindStart[facts.kind + 1];
+
+		for(std::uint32_t i = kindStart[facts.kind]; i < end; i++) {
+			const RuleRow& row = kindRows[i];
+
+			if(!(row.weaponTypeMask & weaponBit) || !(row.armorTypeMask & armorBit)) { continue; }
+			if((facts.flags & row.flagsSet) != row.flagsSet || (facts.flags & row.flagsClear)) { continue; }
+			if(row.slotMask && !(facts.slotMask & row.slotMask)) { continue; }
+			if(!facts.keywords.ContainsAll(row.required) || facts.keywords.Intersects(row.excluded)) { continue; }
+			if(row.hasBounds && !InBounds(row, facts)) { continue; }
+
+			return static_cast<int>(row.category);
+		}
+		return -1;
+	}
+
+	private:
+	static bool InBounds(const RuleRow& row, const ItemFacts& facts)
+	{
+		bool inside = true;
+		for(std::uint32_t m = 0; m < kMetric_Count; m++) inside &= facts.metrics[m] >= row.lower[m] && facts.metrics[m] <= row.upper[m];
+		return inside;
+	}
+};
+
+class RuleProgram
+{
+	public:
+	// Compiles the rule text, on failure the program is left empty and error holds "line N: reason"
+	bool Compile(const char* text, std::string& error);
+
+	RuleTable GetTable() const;
+
+	static const char* GetDefaultRules();
+	static const char* GetMetricName(std::uint8_t metric);
+
+	private:
+	int FindCategory(const std::string& name) const;
+	int AssignKeywordBit(std::uint32_t formID);
+
+	std::vector<RuleRow>	   rows;
+	std::vector<RuleRow>	   kindRows;
+	std::vector<std::uint32_t> kindStart;
+	std::vector<CategoryDef>   categories;
+	std::vector<std::uint32_t> keywordFormIDs;
+};
@@ -0,0 +1,64 @@
+#include "scoring.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <xmmintrin.h>
+
+void ScoreWeights::Reset(const RuleTable& table)
+{
+	weights.assign(table.numCategories * kMetric_Count, 0.0f);
+	for(std::uint32_t i = 0; i < table.numCategories; i++) { weights[i * kMetric_Count + table.categories[i].metric] = 1.0f; }
+}
+
+bool ScoreWeights::SetWeights(std::uint32_t category, const char* text, std::string& error)
+{
+	float parsed[kMetric_Count] = {};
+
+	std::istringstream list(text);
+	std::string		   entry;
+	while(std::getline(list, entry, ',')) {
+		std::istringstream words(entry);
+		std::string		   name, value, rest;
+		if(!(words >> name >> value) || (words >> rest)) {
+			error = "expected '<metric> <weight>' but got '" + entry + "'";
+			return false;
+		}
+
+		int metric = -1;
+		for(std::uint32_t m = 0; m < kMetric_Count; m++) {
+			if(name == RuleProgram::GetMetricName(m)) { metric = m; }
+		}
+		if(metric == -1) {
+			error = "unknown metric '" + name + "'";
+			return false;
+		}
+
+		char* end	   = nullptr;
+		parsed[metric] = static_cast<float>(std::strtod(value.c_str(), &end));
+		if(*end) {
+			error = "'" + value + "' is not a number";
+			return false;
+		}
+	}
+
+	std::memcpy(&weights[category * kMetric_Count], parsed, sizeof(parsed));
+	return true;
+}
+
+void ScoreColumns(const float* const* metricColumns, const float* const* weightColumns, std::uint32_t count, float* scores)
+{
+	std::uint32_t i = 0;
+	for(; i + 4 <= count; i += 4) {
+		__m128 sum = _mm_setzero_ps();
+		for(std::uint32_t m = 0; m < kMetric_Count; m++) { sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(metricColumns[m] + i), _mm_loadu_ps(weightColumns[m] + i))); }
+		_mm_storeu_ps(scores + i, sum);
+	}
+
+	// The last few items go through the scalar path
+	for(; i < count; i++) {
+		float score = 0.0f;
+		for(std::uint32_t m = 0; m < kMetric_Count; m++) score += metricColumns[m][i] * weightColumns[m][i];
+		scores[i] = score;
+	}
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "rules.h"
+
+/*
+Score Weights
+A category scores its items by a weighted sum of their metrics. By default the metric the
+category is ranked by weighs 1 and every other metric 0, the [Weights] section of the INI
+replaces that per category:
+
+	[Weights]
+	1HSword = damage 0.7, speed 0.2, weight -0.1
+
+Metrics left out of a list weigh 0
+*/
+class ScoreWeights
+{
+	public:
+	// One weight per metric and category, each category ranked by its own metric
+	void Reset(const RuleTable& table);
+
+	// Parses "<metric> <weight>, ...", on failure the category keeps its weights
+	bool SetWeights(std::uint32_t category, const char* text, std::string& error);
+
+	// Takes kMetric_Count weights as they are, e.g. read back from a snapshot
+	void SetWeights(std::uint32_t category, const float* values) { std::copy(values, values + kMetric_Count, weights.begin() + category * kMetric_Count); }
+
+	const float* GetWeights(std::uint32_t category) const { return &weights[category * kMetric_Count]; }
+
+	// Sums in the same order as ScoreColumns, so both give identical results
+	float Score(const ItemFacts& facts, std::uint32_t category) const
+	{
+		const float* w	   = GetWeights(category);
+		float		 score = 0.0f;
+		for(std::uint32_t m = 0; m < kMetric_Count; m++) score += facts.metrics[m] * w[m];
+		return score;
+	}
+
+	private:
+	std::vector<float> weights;
+};
+
+/*
+ScoreColumns
+scores[i] is the dot product of item i's metrics and weights. Both are laid out as one column
+of count floats per metric, so four items are scored per SSE instruction. RankingEngine scores
+through ScoreWeights::Score instead, filling the columns costs more than the kernel saves
+*/
+void ScoreColumns(const float* const* metricColumns, const float* const* weightColumns, std::uint32_t count, float* scores);
@@ -0,0 +1,56 @@
+#include "segmentedlog.h"
+
+#include <cstdio>
+#include <cstring>
+
+static std::string GetRolledPath(const std::string& path, std::uint32_t index)
+{
+	return index ? path + "." + std::to_string(index) : path;
+}
+
+bool SegmentedLog::Open(const std::string& logPath, std::size_t size, std::uint32_t keep, std::string& error)
+{
+	Close();
+
+	path		= logPath;
+	segmentSize = size;
+	retention	= keep < 1 ? 1 : keep;
+
+	// The last session's log is kept as the first rolled one
+	return Roll(error);
+}
+
+void SegmentedLog::Close()
+{
+	if(segment.IsOpen()) { segment.Close(used); }
+	used = 0;
+}
+
+bool SegmentedLog::Roll(std::string& error)
+{
+	Close();
+
+	std::remove(GetRolledPath(path, retention - 1).c_str());
+	for(std::uint32_t i = retention - 1; i > 0; i--) std::rename(GetRolledPath(path, i - 1).c_str(), GetRolledPath(path, i).c_str());
+
+	if(!segment.Create(path.c_str(), segmentSize)) {
+		error = "could not create and map \"" + path + "\"";
+		return false;
+	}
+
+	std::memcpy(segment.GetWritableData(), header.data(), header.size());
+	used = header.size();
+	return true;
+}
+
+bool SegmentedLog::Append(const char* text, std::size_t length, std::string& error)
+{
+	if(!segment.IsOpen()) { return false; }
+
+	if(length > segmentSize - header.size()) { length = segmentSize - header.size(); }
+	if(used + length > segmentSize && !Roll(error)) { return false; }
+
+	std::memcpy(segment.GetWritableData() + used, text, length);
+	used += length;
+	return true;
+}
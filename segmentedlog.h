@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "mappedfile.h"
+
+/*
+SegmentedLog
+A log file written through a memory mapping. A segment of segmentSize bytes is allocated and
+mapped up front and lines are copied into it, so appending never calls into the system.
+A full segment is cut to what was written and renamed like logrotate does, path becomes
+path.1, path.1 becomes path.2 and so on, keeping retention files including the one being
+written. The newest lines are always in path.
+
+Until a segment is closed the end of the file is zeroes, a reader sees the lines followed by
+padding. A header set before opening starts every segment, the compressed log's stream header
+*/
+class SegmentedLog
+{
+	public:
+	~SegmentedLog() { Close(); }
+
+	bool Open(const std::string& path, std::size_t segmentSize, std::uint32_t retention, std::string& error);
+	void Close();
+
+	bool IsOpen() const { return segment.IsOpen(); }
+
+	// Lines longer than a segment after its header are cut off, nothing is split across segments
+	bool Append(const char* text, std::size_t length, std::string& error);
+
+	const std::string& GetPath() const { return path; }
+	std::size_t		   GetSegmentSize() const { return segmentSize; }
+	std::uint32_t	   GetRetention() const { return retention; }
+	const std::string& GetHeader() const { return header; }
+
+	void SetHeader(const std::string& text) { header = text; }
+
+	private:
+	bool Roll(std::string& error);
+
+	MappedFile	  segment;
+	std::string	  path;
+	std::string	  header;
+	std::size_t	  segmentSize = 0;
+	std::size_t	  used		  = 0;
+	std::uint32_t retention	  = 0;
+};
@@ -0,0 +1,128 @@
+#include "snapshot.h"
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+bool WriteSnapshot(const char* path, const Snapshot& snapshot, std::string& error)
+{
+	std::ofstream file(path, std::ios::trunc);
+	if(!file) {
+		error = std::string("could not open \"") + path + "\"";
+		return false;
+	}
+
+	// Enough digits for every float to read back exactly
+	file << std::setprecision(9);
+	file << "# BestInClassPP snapshot\n";
+	file << "reason " << snapshot.reason << "\n";
+	file << "menu " << snapshot.menu << "\n";
+	for(const SnapshotTiming& timing : snapshot.timings) file << "timing " << timing.phase << " " << timing.ms << "\n";
+	file << "rules " << std::hex << snapshot.rulesHash << std::dec << " " << snapshot.rulesPath << "\n";
+	file << "generation " << snapshot.generation << "\n";
+	file << "categories " << snapshot.numCategories << " " << snapshot.numRuleCategories << "\n";
+
+	for(std::uint32_t c = 0; c < snapshot.numRuleCategories; c++) {
+		file << "weights " << c;
+		for(std::uint32_t m = 0; m < kMetric_Count; m++) file << " " << snapshot.weights[c * kMetric_Count + m];
+		file << "\n";
+	}
+
+	for(const SnapshotItem& item : snapshot.items) {
+		const ItemFacts& facts = item.facts;
+
+		file << "item " << std::hex << item.formID << std::dec << " " << item.presetCategory << " " << item.presetScore;
+		file << " " << static_cast<int>(facts.kind) << " " << static_cast<int>(facts.weaponType) << " " << static_cast<int>(facts.armorType) << " " << static_cast<int>(facts.flags);
+		file << " " << std::hex << facts.slotMask << std::dec;
+		for(std::uint32_t m = 0; m < kMetric_Count; m++) file << " " << facts.metrics[m];
+		for(std::uint32_t w = 0; w < KeywordSet::numWords; w++) file << " " << std::hex << facts.keywords.words[w] << std::dec;
+		file << " " << item.category << " " << item.score << " " << item.shadowCategory << " " << item.shadowScore << " " << item.name << "\n";
+	}
+
+	if(!file.flush()) {
+		error = std::string("could not write \"") + path + "\"";
+		return false;
+	}
+	return true;
+}
+
+// The rest of the line after one separating space, for values that may contain spaces
+static std::string ReadRest(std::istringstream& line)
+{
+	std::string rest;
+	if(line.peek() == ' ') { line.get(); }
+	std::getline(line, rest);
+	if(!rest.empty() && rest.back() == '\r') { rest.pop_back(); }
+	return rest;
+}
+
+bool ReadSnapshot(const char* path, Snapshot& snapshot, std::string& error)
+{
+	std::ifstream file(path);
+	if(!file) {
+		error = std::string("could not open \"") + path + "\"";
+		return false;
+	}
+
+	snapshot = Snapshot();
+
+	std::string text;
+	int			lineNumber = 0;
+	while(std::getline(file, text)) {
+		lineNumber++;
+		if(text.empty() || text[0] == '#') { continue; }
+
+		std::istringstream line(text);
+		std::string		   key;
+		line >> key;
+
+		bool valid = true;
+		if(key == "reason") {
+			snapshot.reason = ReadRest(line);
+		} else if(key == "menu") {
+			snapshot.menu = ReadRest(line);
+		} else if(key == "timing") {
+			SnapshotTiming timing;
+			valid = static_cast<bool>(line >> timing.phase >> timing.ms);
+			snapshot.timings.push_back(timing);
+		} else if(key == "rules") {
+			valid			   = static_cast<bool>(line >> std::hex >> snapshot.rulesHash >> std::dec);
+			snapshot.rulesPath = ReadRest(line);
+		} else if(key == "generation") {
+			valid = static_cast<bool>(line >> snapshot.generation);
+		} else if(key == "categories") {
+			valid = static_cast<bool>(line >> snapshot.numCategories >> snapshot.numRuleCategories);
+			snapshot.weights.assign(snapshot.numRuleCategories * kMetric_Count, 0.0f);
+		} else if(key == "weights") {
+			std::uint32_t category = 0;
+			valid				   = static_cast<bool>(line >> category) && category < snapshot.numRuleCategories;
+			for(std::uint32_t m = 0; valid && m < kMetric_Count; m++) valid = static_cast<bool>(line >> snapshot.weights[category * kMetric_Count + m]);
+		} else if(key == "item") {
+			SnapshotItem item;
+			ItemFacts&	 facts = item.facts;
+			int			 kind, weaponType, armorType, flags;
+
+			valid = static_cast<bool>(line >> std::hex >> item.formID >> std::dec >> item.presetCategory >> item.presetScore >> kind >> weaponType >> armorType >> flags >> std::hex >> facts.slotMask >> std::dec);
+			for(std::uint32_t m = 0; valid && m < kMetric_Count; m++) valid = static_cast<bool>(line >> facts.metrics[m]);
+			for(std::uint32_t w = 0; valid && w < KeywordSet::numWords; w++) valid = static_cast<bool>(line >> std::hex >> facts.keywords.words[w] >> std::dec);
+			valid = valid && (line >> item.category >> item.score >> item.shadowCategory >> item.shadowScore);
+
+			facts.kind		 = static_cast<ItemKind>(kind);
+			facts.weaponType = static_cast<WeaponKind>(weaponType);
+			facts.armorType	 = static_cast<ArmorKind>(armorType);
+			facts.flags		 = static_cast<std::uint8_t>(flags);
+			item.name		 = ReadRest(line);
+			snapshot.items.push_back(item);
+		} else {
+			error = "line " + std::to_string(lineNumber) + ": unknown key '" + key + "'";
+			return false;
+		}
+
+		if(!valid) {
+			error = "line " + std::to_string(lineNumber) + ": malformed '" + key + "' line";
+			return false;
+		}
+	}
+
+	return true;
+}
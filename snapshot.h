@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "rules.h"
+
+/*
+Inventory Snapshot
+Everything needed to rank a list again without the game: the facts each item's base form gave
+the rules, its preset score and the results the pass came to. Written as text, one item per line
+
+	# BestInClassPP snapshot
+	reason <text>
+	menu <menu name>
+	timing <phase> <milliseconds>
+	rules <source hash> <rules file>
+	generation <n>
+	categories <all> <rule categories>
+	weights <category> <weight per metric...>
+	item <formID> <preset category> <preset score> <kind> <weapon> <armor> <flags> <slot mask>
+		 <metrics...> <keyword words...> <category> <score> <shadow category> <shadow score> <name>
+
+Items that are not weapons, armor or ammo have kind 0, an unset category is -1
+*/
+struct SnapshotItem
+{
+	std::uint32_t formID;
+	int			  presetCategory;
+	float		  presetScore;
+	ItemFacts	  facts;
+	int			  category;
+	float		  score;
+	int			  shadowCategory;
+	float		  shadowScore;
+	std::string	  name;
+};
+
+struct SnapshotTiming
+{
+	std::string	phase;
+	double		ms;
+};
+
+struct Snapshot
+{
+	std::string					reason;
+	std::string					menu;
+	std::vector<SnapshotTiming>	timings;
+	std::string					rulesPath;
+	std::uint64_t				rulesHash		  = 0;
+	std::uint32_t				generation		  = 0;
+	std::uint32_t				numCategories	  = 0;
+	std::uint32_t				numRuleCategories = 0;
+	std::vector<float>			weights; // kMetric_Count per rule category
+	std::vector<SnapshotItem>	items;
+};
+
+bool WriteSnapshot(const char* path, const Snapshot& snapshot, std::string& error);
+
+// On failure error holds "line N: reason"
+bool ReadSnapshot(const char* path, Snapshot& snapshot, std::string& error);
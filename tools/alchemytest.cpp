@@ -0,0 +1,192 @@
+/*
+alchemytest
+Checks AlchemySolver against trying every pair and triple of random ingredients, that a
+reordered list reuses the cached result and that another list of the same length does not,
+then times solving 200 ingredients, a cache hit, and the brute force search. Solving has to fit
+in the watchdog's default budget, it runs on the menu pass
+
+	alchemytest [iterations]
+
+Builds on Windows and Linux without the game headers
+	g++ -std=c++17 -O2 -I.. alchemytest.cpp ../alchemy.cpp ../arena.cpp -o alchemytest
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "../alchemy.h"
+#include "../config.h"
+#include "testing.h"
+
+// Four distinct effects out of the number the game has, each at its own strength
+static void MakeIngredients(std::uint32_t count, std::uint32_t numEffects, std::mt19937& random, std::vector<Ingredient>& ingredients)
+{
+	std::uniform_real_distribution<float> strength(1.0f, 50.0f);
+
+	ingredients.resize(count);
+	for(std::uint32_t i = 0; i < count; i++) {
+		Ingredient& ingredient	 = ingredients[i];
+		ingredient				 = Ingredient();
+		ingredient.formID		 = 0x00034000 + 7 * i;
+		ingredient.numEffects	 = Ingredient::maxEffects;
+		ingredient.totalStrength = 0.0f;
+		for(std::uint32_t e = 0; e < Ingredient::maxEffects; e++) {
+			std::uint32_t bit;
+			do { bit = random() % numEffects; } while(ingredient.effects.Test(bit));
+
+			ingredient.effects.Set(bit);
+			ingredient.effectBits[e] = static_cast<std::uint16_t>(bit);
+			ingredient.strengths[e]	 = strength(random);
+			ingredient.totalStrength += ingredient.strengths[e];
+		}
+	}
+}
+
+// Every effect at least two parts have, at the strength of the strongest of them
+static float ScoreReference(const Ingredient* const* parts, std::uint32_t numParts)
+{
+	float score = 0.0f;
+	for(std::uint32_t p = 0; p < numParts; p++) {
+		for(std::uint32_t e = 0; e < parts[p]->numEffects; e++) {
+			std::uint32_t bit	   = parts[p]->effectBits[e];
+			std::uint32_t having   = 0;
+			float		  strength = 0.0f;
+			bool		  counted  = false;
+			for(std::uint32_t q = 0; q < numParts; q++) {
+				for(std::uint32_t f = 0; f < parts[q]->numEffects; f++) {
+					if(parts[q]->effectBits[f] != bit) { continue; }
+					having++;
+					strength = std::max(strength, parts[q]->strengths[f]);
+					counted |= q < p;
+				}
+			}
+			// Each effect counts once, at the first part having it
+			if(having >= 2 && !counted) { score += strength; }
+		}
+	}
+	return score;
+}
+
+static float SolveReference(const Ingredient* const* ingredients, std::uint32_t count)
+{
+	float best = 0.0f;
+	for(std::uint32_t i = 0; i < count; i++) {
+		for(std::uint32_t j = i + 1; j < count; j++) {
+			const Ingredient* pair[2] = {ingredients[i], ingredients[j]};
+			best					  = std::max(best, ScoreReference(pair, 2));
+			for(std::uint32_t k = j + 1; k < count; k++) {
+				const Ingredient* triple[3] = {ingredients[i], ingredients[j], ingredients[k]};
+				best						= std::max(best, ScoreReference(triple, 3));
+			}
+		}
+	}
+	return best;
+}
+
+// The score has to be the best there is and the formIDs a combination scoring it
+static void CheckResult(const AlchemyResult& result, const std::vector<Ingredient>& ingredients, float reference)
+{
+	CHECK(std::fabs(result.score - reference) <= 1e-3f);
+	if(!CHECK(result.numIngredients <= 3) || !result.numIngredients) { return; }
+
+	const Ingredient* parts[3];
+	for(std::uint32_t p = 0; p < result.numIngredients; p++) {
+		parts[p] = nullptr;
+		for(const Ingredient& ingredient : ingredients) {
+			if(ingredient.formID == result.formIDs[p]) { parts[p] = &ingredient; }
+		}
+		if(!CHECK(parts[p])) { return; }
+	}
+	CHECK(std::fabs(ScoreReference(parts, result.numIngredients) - result.score) <= 1e-3f);
+}
+
+static void TestAgainstReference()
+{
+	Arena						   arena;
+	std::mt19937				   random(41);
+	std::vector<Ingredient>		   ingredients;
+	std::vector<const Ingredient*> list;
+
+	for(std::uint32_t round = 0; round < 300; round++) {
+		MakeIngredients(random() % 40, 20 + random() % 100, random, ingredients);
+		list.clear();
+		for(const Ingredient& ingredient : ingredients) list.push_back(&ingredient);
+
+		AlchemySolver solver;
+		ArenaScope	  scratch(arena);
+		AlchemyResult result = solver.Solve(arena, list.data(), static_cast<std::uint32_t>(list.size()), 1);
+		CheckResult(result, ingredients, SolveReference(list.data(), static_cast<std::uint32_t>(list.size())));
+	}
+}
+
+static void TestCache()
+{
+	Arena						   arena;
+	ArenaScope					   scratch(arena);
+	std::mt19937				   random(410);
+	std::vector<Ingredient>		   first, second;
+	std::vector<const Ingredient*> list;
+	AlchemySolver				   solver;
+
+	MakeIngredients(30, 60, random, first);
+	for(const Ingredient& ingredient : first) list.push_back(&ingredient);
+	float		  reference = SolveReference(list.data(), 30);
+	AlchemyResult result	= solver.Solve(arena, list.data(), 30, 1);
+	CheckResult(result, first, reference);
+
+	// The same ingredients in another order are the same list
+	std::shuffle(list.begin(), list.end(), random);
+	AlchemyResult reordered = solver.Solve(arena, list.data(), 30, 1);
+	CHECK(reordered.score == result.score && reordered.numIngredients == result.numIngredients);
+
+	// As many other ingredients, with formIDs of their own, have to be solved again
+	MakeIngredients(30, 60, random, second);
+	for(std::uint32_t i = 0; i < 30; i++) {
+		second[i].formID = 0x00050000 + i;
+		list[i]			 = &second[i];
+	}
+	CheckResult(solver.Solve(arena, list.data(), 30, 1), second, SolveReference(list.data(), 30));
+}
+
+int main(int argc, char** argv)
+{
+	std::uint32_t iterations = argc > 1 ? static_cast<std::uint32_t>(std::atoi(argv[1])) : 20;
+
+	TestAgainstReference();
+	TestCache();
+
+	// Carrying 200 kinds of ingredients sharing about as many effects as the game has
+	Arena						   arena;
+	AlchemySolver				   solver;
+	std::mt19937				   random(4100);
+	std::vector<Ingredient>		   ingredients;
+	std::vector<const Ingredient*> list;
+	MakeIngredients(200, 60, random, ingredients);
+	for(const Ingredient& ingredient : ingredients) list.push_back(&ingredient);
+
+	auto solve = [&](std::uint32_t generation) {
+		ArenaScope scratch(arena);
+		return solver.Solve(arena, list.data(), 200, generation);
+	};
+
+	float reference = SolveReference(list.data(), 200);
+	CheckResult(solve(1), ingredients, reference);
+
+	double solveNs	   = TimeNs(iterations, [&](std::uint32_t i) { g_sink = g_sink + solve(i + 2).numIngredients; });
+	double hitNs	   = TimeNs(iterations, [&](std::uint32_t) { g_sink = g_sink + solve(iterations + 1).numIngredients; });
+	double referenceNs = TimeNs(1, [&](std::uint32_t) { g_sink = g_sink + static_cast<std::uint64_t>(SolveReference(list.data(), 200)); });
+
+	float budgetMs = Settings().watchdogBudgetMs;
+	CHECK(solveNs / 1e6 < budgetMs);
+
+	std::printf("Solving 200 ingredients with 60 effects, the budget is %.1f ms\n", budgetMs);
+	std::printf("	solver         %10.1f us\n", solveNs / 1000.0);
+	std::printf("	cache hit      %10.1f us\n", hitNs / 1000.0);
+	std::printf("	brute force    %10.1f us\n", referenceNs / 1000.0);
+	return Finish("alchemytest");
+}
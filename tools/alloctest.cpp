@@ -0,0 +1,92 @@
+/*
+alloctest
+Runs ranking passes over a synthetic inventory with the allocation audit built in and checks
+that once the arena has grown to the largest inventory no pass touches the heap, then times a
+pass on the kept arena against one on a fresh arena, which is what every pass paid before
+
+	alloctest [iterations]
+
+Builds on Windows and Linux without the game headers
+	g++ -std=c++17 -O2 -DBICPP_ALLOCATION_AUDIT -I.. alloctest.cpp ../allocaudit.cpp ../arena.cpp ../rules.cpp ../scoring.cpp -o alloctest
+*/
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../allocaudit.h"
+#include "../ranking.h"
+#include "inventory.h"
+#include "testing.h"
+
+int main(int argc, char** argv)
+{
+	std::uint32_t iterations = argc > 1 ? static_cast<std::uint32_t>(std::atoi(argv[1])) : 200;
+
+	if(!CHECK(AllocationAudit::IsEnabled())) { return Finish("alloctest"); }
+	{
+		AllocationScope		 scope;
+		std::unique_ptr<int> counted(new int(0));
+		CHECK(scope.GetCount() == 1);
+	}
+
+	RuleProgram program;
+	std::string error;
+	if(!CHECK(program.Compile(RuleProgram::GetDefaultRules(), error))) { return Finish("alloctest"); }
+
+	RuleTable	 table = program.GetTable();
+	ScoreWeights weights;
+	weights.Reset(table);
+
+	// A small list, the largest one, then lists in between as menus switch
+	Inventory small, large, medium;
+	MakeInventory(table, 50, 120, 30, small);
+	MakeInventory(table, 1500, 4000, 31, large);
+	MakeInventory(table, 600, 1500, 32, medium);
+
+	Arena					  arena;
+	PlainItemPolicy			  policy;
+	std::vector<std::int32_t> best(table.numCategories);
+
+	auto rank = [&](Inventory& inventory) {
+		ArenaScope scratch(arena);
+		RankingEngine<PlainItemPolicy>(arena, table, weights).Rank(policy, inventory.records.data(), static_cast<std::uint32_t>(inventory.records.size()), table.numCategories, best.data());
+	};
+
+	// Growing the arena is the only heap use of the first passes
+	for(Inventory* inventory : {&small, &large}) {
+		std::size_t		blocks = arena.GetBlockAllocations();
+		AllocationScope pass;
+		rank(*inventory);
+		CHECK(pass.GetCount() == arena.GetBlockAllocations() - blocks);
+	}
+	CHECK(arena.GetBlockAllocations() > 1);
+
+	std::size_t blocks = arena.GetBlockAllocations();
+	for(std::uint32_t i = 0; i < 10; i++) {
+		for(Inventory* inventory : {&small, &medium, &large}) {
+			AllocationScope pass;
+			rank(*inventory);
+			CHECK(pass.GetCount() == 0);
+		}
+	}
+	CHECK(arena.GetBlockAllocations() == blocks);
+
+	double keptNs = TimeNs(iterations, [&](std::uint32_t) {
+		rank(large);
+		g_sink = g_sink + best[0];
+	});
+	double freshNs = TimeNs(iterations, [&](std::uint32_t) {
+		Arena fresh;
+		RankingEngine<PlainItemPolicy>(fresh, table, weights).Rank(policy, large.records.data(), static_cast<std::uint32_t>(large.records.size()), table.numCategories, best.data());
+		g_sink = g_sink + best[0];
+	});
+
+	std::printf("Ranking %zu records of %zu forms, %zu arena blocks\n", large.records.size(), large.items.size(), blocks);
+	std::printf("	kept arena       %8.1f us per pass\n", keptNs / 1000.0);
+	std::printf("	fresh arena      %8.1f us per pass\n", freshNs / 1000.0);
+	return Finish("alloctest");
+}
@@ -0,0 +1,199 @@
+/*
+configtest
+Checks IniFile and Settings on INI text and files, FileWatcher against files changing in a
+temporary directory, and that SnapshotSlot frees retired snapshots once no reader holds them
+
+	configtest
+
+Builds on Linux without the game headers
+	g++ -std=c++17 -O2 -I.. configtest.cpp ../config.cpp -o configtest -pthread
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../config.h"
+#include "testing.h"
+
+static void WriteFile(const std::string& path, const std::string& text)
+{
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	file << text;
+}
+
+static void TestIniFile(const std::string& directory)
+{
+	IniFile		ini;
+	std::string error;
+
+	CHECK(ini.Parse("; comment\n[General]\nbVerboseLogging = 0\n\n[Loadout]\r\nfMaxWeight=42.5 ; trailing\r\n# comment\n[Paths]\nsFile = C:\\a;b.txt\n", error));
+	CHECK(!ini.GetBool("General", "bVerboseLogging", true));
+	CHECK(ini.GetFloat("loadout", "FMAXWEIGHT", 0.0f) == 42.5f);
+	CHECK(ini.GetString("Paths", "sFile", "") == "C:\\a;b.txt");
+	CHECK(ini.GetInt("General", "iMissing", 7) == 7);
+	CHECK(ini.GetBool("Missing", "bMissing", true));
+
+	CHECK(ini.Parse("[General]\niHex = 0x10\nbYes = yes\nbOn = ON\nbEmpty =\n", error));
+	CHECK(ini.GetInt("General", "iHex", 0) == 16);
+	CHECK(ini.GetBool("General", "bYes", false) && ini.GetBool("General", "bOn", false));
+	CHECK(ini.GetBool("General", "bEmpty", true));
+
+	CHECK(!ini.Parse("[General\nkey = value\n", error) && error == "line 1: missing ']'");
+	CHECK(!ini.Parse("[General]\n\nno value\n", error) && error == "line 3: expected 'key = value'");
+
+	// Out of range settings are clamped, the rest keep their defaults
+	std::string path = directory + "/test.ini";
+	WriteFile(path, "[General]\niPollIntervalMs = 5\n[Performance]\niPrefetchDistance = 1000\n[Watchdog]\niMaxSnapshots = 0\n");
+	CHECK(ini.Load(path.c_str(), error));
+
+	Settings settings;
+	settings.Read(ini);
+	CHECK(settings.pollIntervalMs == 100);
+	CHECK(settings.prefetchDistance == 64);
+	CHECK(settings.maxSnapshots == 1);
+	CHECK(settings.rankPotions == Settings().rankPotions);
+
+	CHECK(!ini.Load((directory + "/missing.ini").c_str(), error));
+}
+
+static void TestFileWatcher(const std::string& directory)
+{
+	std::string first  = directory + "/first.txt";
+	std::string second = directory + "/second.txt";
+	WriteFile(first, "one");
+
+	FileWatcher watcher;
+	watcher.SetPaths({first, second});
+	CHECK(!watcher.Poll());
+
+	CHECK(watcher.GetPath(0) == first && watcher.GetPath(1) == second && watcher.GetPath(2).empty());
+
+	// Edits keeping the size right away are told apart by the time below a second or by the
+	// contents, whichever the filesystem allows
+	WriteFile(first, "one two");
+	CHECK(watcher.Poll());
+	CHECK(!watcher.Poll());
+	WriteFile(first, "one six");
+	CHECK(watcher.Poll());
+	CHECK(!watcher.Poll());
+
+	// On a filesystem with a coarse clock the time stays the same, the contents still differ
+	struct stat info;
+	stat(first.c_str(), &info);
+	WriteFile(first, "one ten");
+	struct timespec times[2] = {info.st_atim, info.st_mtim};
+	utimensat(AT_FDCWD, first.c_str(), times, 0);
+	CHECK(watcher.Poll());
+	CHECK(!watcher.Poll());
+
+	WriteFile(second, "created");
+	CHECK(watcher.Poll());
+	std::remove(second.c_str());
+	CHECK(watcher.Poll());
+
+	// The background thread calls back on a change and may replace the paths from the callback
+	std::atomic<std::uint32_t> calls(0);
+	watcher.Start(10, [&] {
+		calls++;
+		watcher.SetPaths({first});
+	});
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	CHECK(calls == 0);
+
+	WriteFile(first, "one two three");
+	for(std::uint32_t i = 0; i < 200 && !calls; i++) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	CHECK(calls == 1);
+
+	watcher.Stop();
+	WriteFile(first, "stopped");
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	CHECK(calls == 1);
+}
+
+struct Counted
+{
+	static std::atomic<std::int32_t> alive;
+
+	std::uint32_t generation;
+
+	explicit Counted(std::uint32_t generation) : generation(generation) { alive++; }
+	~Counted() { alive--; }
+};
+
+std::atomic<std::int32_t> Counted::alive(0);
+
+static void TestSnapshotSlot()
+{
+	{
+		SnapshotSlot<Counted> slot;
+		CHECK(!SnapshotSlot<Counted>::Reader(slot).Get());
+
+		slot.Publish(std::unique_ptr<Counted>(new Counted(1)));
+		slot.Publish(std::unique_ptr<Counted>(new Counted(2)));
+		CHECK(Counted::alive == 1 && slot.GetNumRetired() == 0);
+
+		// A reader keeps its snapshot and everything retired after it
+		{
+			SnapshotSlot<Counted>::Reader reader(slot);
+			slot.Publish(std::unique_ptr<Counted>(new Counted(3)));
+			slot.Publish(std::unique_ptr<Counted>(new Counted(4)));
+			CHECK(reader.Get()->generation == 2);
+			CHECK(SnapshotSlot<Counted>::Reader(slot).Get()->generation == 4);
+			CHECK(Counted::alive == 3 && slot.GetNumRetired() == 2);
+		}
+
+		slot.Publish(std::unique_ptr<Counted>(new Counted(5)));
+		CHECK(Counted::alive == 1 && slot.GetNumRetired() == 0);
+
+		// Readers on other threads against a publisher, every snapshot a reader gets stays intact
+		std::atomic<bool>		   stop(false);
+		std::atomic<std::uint32_t> torn(0);
+		std::vector<std::thread>   threads;
+		for(std::uint32_t t = 0; t < 4; t++) {
+			threads.emplace_back([&] {
+				while(!stop) {
+					SnapshotSlot<Counted>::Reader reader(slot);
+					std::uint32_t				  generation = reader.Get()->generation;
+					for(std::uint32_t i = 0; i < 100; i++) torn += reader.Get()->generation != generation;
+				}
+			});
+		}
+		for(std::uint32_t g = 6; g < 20000; g++) slot.Publish(std::unique_ptr<Counted>(new Counted(g)));
+		stop = true;
+		for(std::thread& thread : threads) thread.join();
+		CHECK(torn == 0);
+
+		slot.Publish(std::unique_ptr<Counted>(new Counted(20000)));
+		CHECK(Counted::alive == 1);
+	}
+	CHECK(Counted::alive == 0);
+}
+
+int main()
+{
+	char directory[] = "/tmp/configtestXXXXXX";
+	if(!mkdtemp(directory)) {
+		std::printf("could not create a temporary directory\n");
+		return 1;
+	}
+
+	TestIniFile(directory);
+	TestFileWatcher(directory);
+	TestSnapshotSlot();
+
+	std::remove((std::string(directory) + "/test.ini").c_str());
+	std::remove((std::string(directory) + "/first.txt").c_str());
+	rmdir(directory);
+	return Finish("configtest");
+}
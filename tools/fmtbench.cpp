@@ -0,0 +1,92 @@
+/*
+fmtbench
+Times the formatter in format.h against vsnprintf on the kind of lines the plugin logs, and
+checks both give the same text for them and for a spread of random values
+
+	fmtbench [iterations]
+
+Builds on Windows and Linux without the game headers, on Windows vsnprintf stands in for
+the vsprintf_s the plugin used before
+	g++ -std=c++14 -O2 -I.. fmtbench.cpp ../format.cpp -o fmtbench
+*/
+
+#include <chrono>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+#include "../format.h"
+
+// The way the plugin formatted before, varargs through one function
+static void FormatVarargs(char* buffer, std::size_t size, const char* fmt, ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	vsnprintf(buffer, size, fmt, args);
+	va_end(args);
+}
+
+static std::uint32_t g_mismatches = 0;
+
+template<class Format, class... Args>
+static void Compare(Format format, const Args&... args)
+{
+	char ours[1024], theirs[1024];
+	FormatText(ours, sizeof(ours), format, args...);
+	FormatVarargs(theirs, sizeof(theirs), Format::Get(), args...);
+	if(std::strcmp(ours, theirs) && g_mismatches++ < 10) { std::printf("mismatch for \"%s\"\n	ours   %s\n	theirs %s\n", Format::Get(), ours, theirs); }
+}
+
+template<class Function>
+static double Time(std::uint32_t iterations, Function function)
+{
+	auto start = std::chrono::steady_clock::now();
+	for(std::uint32_t i = 0; i < iterations; i++) function(i);
+	return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+int main(int argc, char** argv)
+{
+	std::uint32_t iterations = argc > 1 ? static_cast<std::uint32_t>(std::atoi(argv[1])) : 1000000;
+
+	// Random values through every conversion the plugin uses
+	std::mt19937_64 random(1);
+	for(std::uint32_t i = 0; i < 200000; i++) {
+		std::uint64_t bits = random();
+		double		  value;
+		std::memcpy(&value, &bits, sizeof(value));
+		if(value != value) { continue; }
+
+		float		  small	  = static_cast<float>(static_cast<std::int64_t>(bits % 2000000) - 1000000) / static_cast<float>(1 << (bits >> 60));
+		std::int32_t  integer = static_cast<std::int32_t>(bits);
+		std::uint32_t formID  = static_cast<std::uint32_t>(bits >> 32);
+		Compare(BIC_FMT("%f %.1f %.2f %.9f"), value, small, small, static_cast<double>(small));
+		Compare(BIC_FMT("%d %u %08X %x %5d|%-5d|%05d"), integer, formID, formID, formID, integer % 1000, integer % 1000, integer % 1000);
+	}
+	Compare(BIC_FMT("%s %c %% %10s|%-10s|"), "text", 'c', "right", "left");
+
+	char		 buffer[1024];
+	const char*	 name	= "Daedric Greatsword of the Inferno";
+	std::int32_t count	= 245;
+	float		 weight = 23.5f;
+	double		 ms		= 8.734;
+
+	double oursMs = Time(iterations, [&](std::uint32_t i) {
+		FormatText(buffer, sizeof(buffer), BIC_FMT("Item %s has baseFormID %08X"), name, 0x0001C4E6 + i);
+		FormatText(buffer, sizeof(buffer), BIC_FMT("Ranking %d items of %s took %.2f ms, over the budget of %.2f ms"), count, name, ms, 8.0f);
+		FormatText(buffer, sizeof(buffer), BIC_FMT("		Last Item: %s with %.1f %s"), name, weight, "damage");
+	});
+	double theirsMs = Time(iterations, [&](std::uint32_t i) {
+		FormatVarargs(buffer, sizeof(buffer), "Item %s has baseFormID %08X", name, 0x0001C4E6 + i);
+		FormatVarargs(buffer, sizeof(buffer), "Ranking %d items of %s took %.2f ms, over the budget of %.2f ms", count, name, ms, 8.0f);
+		FormatVarargs(buffer, sizeof(buffer), "		Last Item: %s with %.1f %s", name, weight, "damage");
+	});
+
+	std::printf("%u mismatches\n", g_mismatches);
+	std::printf("format.h  %.1f ns per three lines\n", oursMs);
+	std::printf("vsnprintf %.1f ns per three lines\n", theirsMs);
+	return g_mismatches ? 1 : 0;
+}
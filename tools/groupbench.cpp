@@ -0,0 +1,95 @@
+/*
+groupbench
+Checks ItemGroups, then ranks duplicate heavy synthetic inventories through the engine twice:
+as they are, where records of one form share a key and the form is classified and scored once,
+and with every record pointing to its own copy of the form, which is what each item cost
+before grouping. Both have to give every record the same category and score
+
+	groupbench [iterations]
+
+Builds on Windows and Linux without the game headers
+	g++ -std=c++17 -O2 -I.. groupbench.cpp ../arena.cpp ../rules.cpp ../scoring.cpp -o groupbench
+*/
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "../ranking.h"
+#include "inventory.h"
+#include "testing.h"
+
+static void TestItemGroups()
+{
+	Arena		arena;
+	ArenaScope	scratch(arena);
+	ItemGroups	groups(arena, 100);
+	int			forms[100];
+	bool		added;
+
+	for(std::uint32_t i = 0; i < 100; i++) {
+		ItemGroups::Group& group = groups.Find(&forms[i], added);
+		CHECK(added && group.form == &forms[i] && group.category == -1);
+		group.category = static_cast<int>(i);
+	}
+	for(std::uint32_t i = 0; i < 100; i += 7) {
+		ItemGroups::Group& group = groups.Find(&forms[i], added);
+		CHECK(!added && group.category == static_cast<int>(i));
+	}
+	CHECK(groups.GetNumGroups() == 100);
+}
+
+int main(int argc, char** argv)
+{
+	std::uint32_t iterations = argc > 1 ? static_cast<std::uint32_t>(std::atoi(argv[1])) : 200;
+
+	TestItemGroups();
+
+	RuleProgram program;
+	std::string error;
+	if(!CHECK(program.Compile(RuleProgram::GetDefaultRules(), error))) { return Finish("groupbench"); }
+
+	RuleTable	 table = program.GetTable();
+	ScoreWeights weights;
+	weights.Reset(table);
+
+	Arena					  arena;
+	PlainItemPolicy			  policy;
+	std::vector<std::int32_t> best(table.numCategories);
+	std::vector<std::int32_t> ungroupedBest(table.numCategories);
+
+	const std::uint32_t numRecords = 4000;
+	std::printf("Ranking %u records\n", numRecords);
+	for(std::uint32_t numForms : {4000u, 1000u, 250u, 50u}) {
+		Inventory inventory;
+		MakeInventory(table, numForms, numRecords, numForms, inventory);
+
+		// Every record gets its own copy of its form, so no two share a key
+		std::vector<PlainItem>				 copies(numRecords);
+		std::vector<PlainItemPolicy::Record> ungrouped(numRecords);
+		for(std::uint32_t i = 0; i < numRecords; i++) {
+			copies[i]	 = *inventory.records[i].item;
+			ungrouped[i] = {&copies[i], -1, 0.0f};
+		}
+
+		auto rank = [&](PlainItemPolicy::Record* records, std::int32_t* bestRecords) {
+			ArenaScope scratch(arena);
+			RankingEngine<PlainItemPolicy>(arena, table, weights).Rank(policy, records, numRecords, table.numCategories, bestRecords);
+		};
+
+		rank(inventory.records.data(), best.data());
+		rank(ungrouped.data(), ungroupedBest.data());
+		for(std::uint32_t i = 0; i < numRecords; i++) CHECK(inventory.records[i].category == ungrouped[i].category && inventory.records[i].score == ungrouped[i].score);
+		CHECK(best == ungroupedBest);
+
+		double groupedNs   = TimeNs(iterations, [&](std::uint32_t) { rank(inventory.records.data(), best.data()); });
+		double ungroupedNs = TimeNs(iterations, [&](std::uint32_t) { rank(ungrouped.data(), ungroupedBest.data()); });
+		g_sink			   = g_sink + best[0] + ungroupedBest[0];
+
+		std::printf("	%4u forms  grouped %7.1f us  one per record %7.1f us\n", numForms, groupedNs / 1000.0, ungroupedNs / 1000.0);
+	}
+
+	return Finish("groupbench");
+}
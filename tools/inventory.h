@@ -0,0 +1,75 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "../ranking.h"
+
+/*
+Synthetic Inventory
+PlainItems spread over the built-in categories like a late game inventory: weapons, armor and
+ammo, most of them carrying the vanilla keywords of their type, and a tenth of misc items the
+rules skip. The records reference the items in random order, every item once and the rest as
+duplicates, the way stacks split by extra data share one base form
+*/
+struct Inventory
+{
+	std::vector<PlainItem>				 items;
+	std::vector<PlainItemPolicy::Record> records;
+};
+
+inline void SetKeyword(const RuleTable& table, std::uint32_t formID, KeywordSet& keywords)
+{
+	for(std::uint32_t bit = 0; bit < table.numKeywords; bit++) {
+		if(table.keywordFormIDs[bit] == formID) { keywords.Set(bit); }
+	}
+}
+
+inline void MakeInventory(const RuleTable& table, std::uint32_t numItems, std::uint32_t numRecords, std::uint32_t seed, Inventory& inventory)
+{
+	// The WeapType keyword of every weapon kind up to crossbows, ArmorLight and ArmorHeavy, the slots
+	static const std::uint32_t weaponKeywords[]	= {0, 0x0001E711, 0x0001E713, 0x0001E712, 0x0001E714, 0x0006D931, 0x0006D932, 0x0001E715, 0x0001E715};
+	static const std::uint32_t armorKeywords[]	= {0, 0x0006BBD3, 0x0006BBD2};
+	static const std::uint32_t slotKeywords[]	= {0x0006C0EC, 0x0006C0ED, 0x0006C0EF, 0x0006C0EE, 0x000965B2};
+	static const std::uint32_t slotMasks[]		= {1 << 2, 1 << 7, 1 << 3, 1 << 1, 1 << 9};
+
+	std::mt19937						  random(seed);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+	inventory.items.assign(numItems, PlainItem());
+	for(PlainItem& item : inventory.items) {
+		bool		  tagged = random() % 3 != 0;
+		std::uint32_t roll	 = random() % 10;
+		if(roll < 4) {
+			item.kind					 = kKind_Weapon;
+			item.weaponType				 = static_cast<WeaponKind>(1 + random() % kWeapon_HandToHand);
+			item.flags					 = random() % 4 ? 0 : kItemFlag_Enchanted;
+			item.metrics[kMetric_Damage] = 1.0f + 29.0f * unit(random);
+			item.metrics[kMetric_Speed]	 = 0.5f + 0.8f * unit(random);
+			if(tagged && item.weaponType <= kWeapon_Crossbow) { SetKeyword(table, weaponKeywords[item.weaponType], item.keywords); }
+		} else if(roll < 8) {
+			std::uint32_t slot			= random() % 5;
+			item.kind					= kKind_Armor;
+			item.armorType				= static_cast<ArmorKind>(1 + random() % 3);
+			item.slotMask				= slotMasks[slot];
+			item.flags					= random() % 4 ? 0 : kItemFlag_Enchanted;
+			item.metrics[kMetric_Armor]	= 5.0f + 75.0f * unit(random);
+			if(tagged && item.armorType != kArmor_Clothing) {
+				SetKeyword(table, armorKeywords[item.armorType], item.keywords);
+				SetKeyword(table, slotKeywords[slot], item.keywords);
+			}
+		} else if(roll < 9) {
+			item.kind					 = kKind_Ammo;
+			item.flags					 = random() % 4 ? 0 : kItemFlag_Bolt;
+			item.metrics[kMetric_Damage] = 5.0f + 20.0f * unit(random);
+		}
+		item.metrics[kMetric_Weight] = 0.1f + 50.0f * unit(random);
+		item.metrics[kMetric_Value]	 = 1.0f + 3000.0f * unit(random);
+	}
+
+	inventory.records.resize(numRecords);
+	for(std::uint32_t i = 0; i < numRecords; i++) inventory.records[i] = {&inventory.items[i < numItems ? i : random() % numItems], -1, 0.0f};
+	std::shuffle(inventory.records.begin(), inventory.records.end(), random);
+}
@@ -0,0 +1,141 @@
+/*
+loadouttest
+Checks SolveLoadout against SolveLoadoutExhaustive on random small armor sets and that every
+chosen set holds one piece per slot at most, stays within the budget and adds up to the score
+it reports. A hooded robe covering body and head must not be worn with a helmet. Then times the solver on a few pieces next to the exhaustive search and on the
+hundreds of pieces a hoarder carries
+
+	loadouttest [iterations]
+
+Builds on Windows and Linux without the game headers
+	g++ -std=c++17 -O2 -I.. loadouttest.cpp ../arena.cpp ../loadout.cpp -o loadouttest
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "../loadout.h"
+#include "testing.h"
+
+static void MakeArmor(std::uint32_t count, std::mt19937& random, std::vector<LoadoutItem>& items)
+{
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+	items.resize(count);
+	for(std::uint32_t i = 0; i < count; i++) {
+		// A few pieces belong to no slot or add nothing, the solver has to leave them out. Some
+		// cover a second slot, like hooded robes
+		std::uint32_t slots = random() % 12 ? LoadoutSlotBit(static_cast<LoadoutSlot>(random() % kLoadout_NumSlots)) : 0;
+		if(slots && random() % 6 == 0) { slots |= LoadoutSlotBit(static_cast<LoadoutSlot>(random() % kLoadout_NumSlots)); }
+		items[i] = {1000 + i, slots, 0.5f + 30.0f * unit(random), random() % 20 ? 5.0f + 45.0f * unit(random) : 0.0f};
+	}
+}
+
+// The set has to be one the exhaustive search could have picked and score what SolveLoadout says
+static bool CheckChosen(const std::vector<LoadoutItem>& items, const std::uint32_t* chosen, std::uint32_t numChosen, float budget, float step, float score)
+{
+	std::uint32_t used	 = 0;
+	float		  weight = 0.0f;
+	float		  total	 = 0.0f;
+
+	for(std::uint32_t i = 0; i < numChosen; i++) {
+		const LoadoutItem& item = items[chosen[i] - 1000];
+		if(!item.slots || (item.slots & used)) { return false; }
+		used |= item.slots;
+		weight += std::ceil(item.weight / step - 1e-4f) * step;
+		total += item.score;
+	}
+	return weight <= budget + 1e-3f && std::fabs(total - score) <= 1e-3f * std::max(1.0f, score);
+}
+
+static void TestAgainstExhaustive()
+{
+	Arena					 arena;
+	std::mt19937			 random(38);
+	std::vector<LoadoutItem> items;
+	std::uint32_t			 chosen[kLoadout_NumSlots];
+
+	for(std::uint32_t round = 0; round < 2000; round++) {
+		MakeArmor(random() % 16, random, items);
+		float budget = static_cast<float>(random() % 120);
+		float step	 = round % 3 ? 0.5f : 1.0f;
+
+		ArenaScope	  scratch(arena);
+		float		  score;
+		std::uint32_t numChosen = SolveLoadout(arena, items.data(), static_cast<std::uint32_t>(items.size()), budget, step, chosen, score);
+		float		  reference = SolveLoadoutExhaustive(items.data(), static_cast<std::uint32_t>(items.size()), budget, step);
+
+		CHECK(std::fabs(reference - score) <= 1e-3f * std::max(1.0f, reference));
+		CHECK(CheckChosen(items, chosen, numChosen, budget, step, score));
+	}
+
+	// Nothing fits a negative budget and a zero step is refused
+	float score;
+	MakeArmor(10, random, items);
+	CHECK(SolveLoadout(arena, items.data(), 10, -1.0f, 0.5f, chosen, score) == 0 && score == 0.0f);
+	CHECK(SolveLoadout(arena, items.data(), 10, 60.0f, 0.0f, chosen, score) == 0 && score == 0.0f);
+}
+
+static void TestHoodedRobe()
+{
+	Arena		  arena;
+	std::uint32_t chosen[kLoadout_NumSlots];
+	float		  score;
+
+	std::uint32_t body = LoadoutSlotBit(kLoadout_Body);
+	std::uint32_t head = LoadoutSlotBit(kLoadout_Head);
+
+	// The robe beats the cuirass on its own, but not the cuirass and the helmet together
+	std::vector<LoadoutItem> items = {{1000, body | head, 1.0f, 25.0f}, {1001, body, 20.0f, 20.0f}, {1002, head, 5.0f, 10.0f}};
+	std::uint32_t			 numChosen = SolveLoadout(arena, items.data(), 3, 60.0f, 0.5f, chosen, score);
+	CHECK(numChosen == 2 && score == 30.0f && CheckChosen(items, chosen, numChosen, 60.0f, 0.5f, score));
+
+	// Once the robe is better, the helmet is left out along with the cuirass
+	items[0].score = 35.0f;
+	numChosen	   = SolveLoadout(arena, items.data(), 3, 60.0f, 0.5f, chosen, score);
+	CHECK(numChosen == 1 && chosen[0] == 1000 && score == 35.0f);
+
+	// Boots still go with the robe
+	items.push_back({1003, LoadoutSlotBit(kLoadout_Feet), 3.0f, 8.0f});
+	numChosen = SolveLoadout(arena, items.data(), 4, 60.0f, 0.5f, chosen, score);
+	CHECK(numChosen == 2 && score == 43.0f && CheckChosen(items, chosen, numChosen, 60.0f, 0.5f, score));
+	CHECK(SolveLoadoutExhaustive(items.data(), 4, 60.0f, 0.5f) == 43.0f);
+}
+
+int main(int argc, char** argv)
+{
+	std::uint32_t iterations = argc > 1 ? static_cast<std::uint32_t>(std::atoi(argv[1])) : 200;
+
+	TestAgainstExhaustive();
+	TestHoodedRobe();
+
+	Arena					 arena;
+	std::mt19937			 random(380);
+	std::vector<LoadoutItem> items;
+	std::uint32_t			 chosen[kLoadout_NumSlots];
+	float					 score;
+
+	auto solve = [&](std::uint32_t) {
+		ArenaScope scratch(arena);
+		g_sink = g_sink + SolveLoadout(arena, items.data(), static_cast<std::uint32_t>(items.size()), 60.0f, 0.5f, chosen, score);
+	};
+
+	std::printf("Solving for a weight of 60 in steps of 0.5\n");
+	MakeArmor(25, random, items);
+	double solveNs		= TimeNs(iterations, solve);
+	double exhaustiveNs = TimeNs(iterations, [&](std::uint32_t) { g_sink = g_sink + static_cast<std::uint64_t>(SolveLoadoutExhaustive(items.data(), 25, 60.0f, 0.5f)); });
+	std::printf("	%4u pieces  solver %8.1f us  exhaustive %8.1f us\n", 25u, solveNs / 1000.0, exhaustiveNs / 1000.0);
+
+	for(std::uint32_t count : {200u, 500u, 2000u}) {
+		MakeArmor(count, random, items);
+		solveNs = TimeNs(iterations, solve);
+		std::printf("	%4u pieces  solver %8.1f us\n", count, solveNs / 1000.0);
+	}
+
+	return Finish("loadouttest");
+}
@@ -0,0 +1,100 @@
+/*
+logqueuetest
+Has 16 threads log 200k numbered messages each through LogQueue while its flush thread writes
+them out, then drains the rest. The messages have to arrive in the order of their sequence
+numbers, every thread's in the order it logged them, and none may be dropped however far the
+threads get ahead of the flush thread. Reports how many messages per second the threads got
+through
+
+	logqueuetest [threads] [messages]
+
+Builds on Windows and Linux without the game headers
+	g++ -std=c++17 -O2 -I.. logqueuetest.cpp ../format.cpp ../logqueue.cpp -o logqueuetest -pthread
+*/
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../format.h"
+#include "../logqueue.h"
+#include "testing.h"
+
+// Only the flush thread, or main once the producers are done, writes these
+struct Received
+{
+	std::vector<std::int64_t> lastCounter;
+	std::uint64_t			  nextSequence	= 0;
+	std::uint64_t			  numMessages	= 0;
+	std::uint64_t			  numNoted		= 0;
+	bool					  inOrder		= true;
+	bool					  threadInOrder = true;
+};
+
+static Received g_received;
+
+static void WriteRecord(const LogRecord& record)
+{
+	// Every message takes a sequence in turn, a note carries the sequence of the message coming
+	// after it
+	std::string	 text(record.text, record.length);
+	unsigned int thread, counter, dropped;
+	if(std::sscanf(text.c_str(), "ERROR: %u log messages were dropped", &dropped) == 1) {
+		g_received.inOrder &= record.sequence == g_received.nextSequence;
+		g_received.numNoted += dropped;
+		return;
+	}
+
+	g_received.inOrder &= record.sequence == g_received.nextSequence++;
+	if(std::sscanf(text.c_str(), "thread %u message %u", &thread, &counter) == 2 && thread < g_received.lastCounter.size()) {
+		g_received.threadInOrder &= static_cast<std::int64_t>(counter) > g_received.lastCounter[thread];
+		g_received.lastCounter[thread] = counter;
+		g_received.numMessages++;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::uint32_t numThreads  = argc > 1 ? static_cast<std::uint32_t>(std::atoi(argv[1])) : 16;
+	std::uint32_t numMessages = argc > 2 ? static_cast<std::uint32_t>(std::atoi(argv[2])) : 200000;
+
+	g_received.lastCounter.assign(numThreads, -1);
+
+	LogQueue* queue = LogQueue::GetSingleton();
+	queue->Start(1, WriteRecord);
+
+	// A thread outrunning the flush thread chains more buffers to its ring instead of waiting
+	std::vector<std::thread> producers;
+	auto					 start = std::chrono::steady_clock::now();
+	for(std::uint32_t t = 0; t < numThreads; t++) {
+		producers.emplace_back([t, numMessages] {
+			char message[64];
+			for(std::uint32_t i = 0; i < numMessages; i++) {
+				std::size_t length = FormatText(message, sizeof(message), BIC_FMT("thread %u message %u"), t, i);
+				LogQueue::GetSingleton()->Push(message, static_cast<std::uint32_t>(length));
+			}
+		});
+	}
+	for(std::thread& producer : producers) producer.join();
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	// Every message is complete now, one flush writes what is left and notes the last drops
+	queue->Flush();
+
+	std::uint64_t total	  = static_cast<std::uint64_t>(numThreads) * numMessages;
+	std::uint64_t dropped = queue->GetDropped();
+	CHECK(g_received.inOrder);
+	CHECK(g_received.threadInOrder);
+	CHECK(dropped == 0 && g_received.numNoted == 0);
+	CHECK(g_received.numMessages == total);
+
+	std::printf("%u threads logging %u messages each\n", numThreads, numMessages);
+	std::printf("	written %llu, dropped %llu\n", static_cast<unsigned long long>(g_received.numMessages), static_cast<unsigned long long>(dropped));
+	std::printf("	%.2f million messages per second over all threads, formatting included\n", total / seconds / 1e6);
+	return Finish("logqueuetest");
+}
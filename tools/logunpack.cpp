@@ -0,0 +1,152 @@
+/*
+logunpack
+Turns a compressed mapped log, written with [Logging] bCompressLog, back into the plain log
+
+	logunpack <log> [out.txt]
+	logunpack -b <plain.txt> [iterations]
+
+Without an output file the text goes to stdout. A segment the game still writes ends in
+zeroes, its text up to there comes out. With -b a plain log is compressed in blocks the way
+the plugin does and the throughput, the ratio and the round trip are reported
+	g++ -std=c++14 -O2 -I.. logunpack.cpp ../logcompress.cpp -o logunpack
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "../logcompress.h"
+
+static bool ReadFile(const char* path, std::vector<std::uint8_t>& data)
+{
+	std::ifstream file(path, std::ios::binary);
+	if(!file) { return false; }
+	data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	return true;
+}
+
+static std::uint32_t Read32(const std::uint8_t* p)
+{
+	std::uint32_t value;
+	std::memcpy(&value, p, sizeof(value));
+	return value;
+}
+
+static int Unpack(const char* inPath, const char* outPath)
+{
+	std::vector<std::uint8_t> data;
+	if(!ReadFile(inPath, data)) {
+		std::fprintf(stderr, "could not read \"%s\"\n", inPath);
+		return 1;
+	}
+	if(data.size() < kLogStreamHeaderSize || std::memcmp(data.data(), kLogStreamMagic, sizeof(kLogStreamMagic))) {
+		std::fprintf(stderr, "\"%s\" is not a compressed log\n", inPath);
+		return 1;
+	}
+	if(data[4] != kLogStreamVersion) {
+		std::fprintf(stderr, "\"%s\" is version %u, this reads %u\n", inPath, data[4], kLogStreamVersion);
+		return 1;
+	}
+
+	std::FILE* out = outPath ? std::fopen(outPath, "wb") : stdout;
+	if(!out) {
+		std::fprintf(stderr, "could not write \"%s\"\n", outPath);
+		return 1;
+	}
+
+	// A damaged block is reported and skipped, the frame header says where the next one starts
+	std::vector<std::uint8_t> block(LogCompressor::blockSize);
+	std::size_t				  position = kLogStreamHeaderSize;
+	std::uint32_t			  damaged  = 0;
+	while(data.size() - position >= kLogFrameHeaderSize) {
+		std::uint32_t rawSize	 = Read32(&data[position]);
+		std::uint32_t storedSize = Read32(&data[position + 4]);
+		if(!rawSize) { break; }
+
+		bool		stored = (storedSize & kLogFrameStored) != 0;
+		std::size_t size   = storedSize & ~kLogFrameStored;
+		position += kLogFrameHeaderSize;
+		if(rawSize > block.size() || size > data.size() - position) {
+			std::fprintf(stderr, "frame at %zu is cut off or damaged, stopping\n", position - kLogFrameHeaderSize);
+			damaged++;
+			break;
+		}
+
+		std::size_t written = 0;
+		if(stored ? size == rawSize : DecompressBlock(&data[position], size, block.data(), rawSize, written) && written == rawSize) {
+			std::fwrite(stored ? &data[position] : block.data(), 1, rawSize, out);
+		} else {
+			std::fprintf(stderr, "block at %zu is damaged, %u bytes of text lost\n", position - kLogFrameHeaderSize, rawSize);
+			damaged++;
+		}
+		position += size;
+	}
+
+	if(outPath) { std::fclose(out); }
+	return damaged ? 1 : 0;
+}
+
+static int Bench(const char* path, std::uint32_t iterations)
+{
+	std::vector<std::uint8_t> text;
+	if(!ReadFile(path, text) || text.empty()) {
+		std::fprintf(stderr, "could not read \"%s\"\n", path);
+		return 1;
+	}
+
+	// Every block compressed once to check the round trip and for the ratio, then timed
+	std::size_t							   blockSize = LogCompressor::blockSize;
+	std::vector<std::vector<std::uint8_t>> blocks;
+	std::vector<std::uint32_t>			   table(kCompressTableSize);
+	std::vector<std::uint8_t>			   block(blockSize);
+	std::size_t							   totalCompressed = 0;
+	bool								   same			   = true;
+	for(std::size_t offset = 0; offset < text.size(); offset += blockSize) {
+		std::size_t size = std::min(blockSize, text.size() - offset);
+		blocks.emplace_back(GetCompressBound(size));
+		blocks.back().resize(CompressBlock(&text[offset], size, blocks.back().data(), blocks.back().size(), table.data()));
+
+		std::size_t written = 0;
+		same				= same && DecompressBlock(blocks.back().data(), blocks.back().size(), block.data(), block.size(), written) && written == size && !std::memcmp(block.data(), &text[offset], size);
+		totalCompressed += kLogFrameHeaderSize + blocks.back().size();
+	}
+
+	std::vector<std::uint8_t> compressed(GetCompressBound(blockSize));
+	auto					  start = std::chrono::steady_clock::now();
+	for(std::uint32_t i = 0; i < iterations; i++) {
+		for(std::size_t offset = 0; offset < text.size(); offset += blockSize) CompressBlock(&text[offset], std::min(blockSize, text.size() - offset), compressed.data(), compressed.size(), table.data());
+	}
+	double compressSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	start = std::chrono::steady_clock::now();
+	for(std::uint32_t i = 0; i < iterations; i++) {
+		for(const std::vector<std::uint8_t>& packed : blocks) {
+			std::size_t written = 0;
+			DecompressBlock(packed.data(), packed.size(), block.data(), block.size(), written);
+		}
+	}
+	double decompressSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	double megabytes = static_cast<double>(text.size()) * iterations / (1024.0 * 1024.0);
+	std::printf("%zu bytes of text, %zu compressed, ratio %.2f\n", text.size(), totalCompressed, static_cast<double>(text.size()) / totalCompressed);
+	std::printf("compress   %.0f MB/s\n", megabytes / compressSeconds);
+	std::printf("decompress %.0f MB/s\n", megabytes / decompressSeconds);
+	std::printf("round trip %s\n", same ? "OK" : "FAILED");
+	return same ? 0 : 1;
+}
+
+int main(int argc, char** argv)
+{
+	if(argc > 2 && !std::strcmp(argv[1], "-b")) { return Bench(argv[2], argc > 3 ? static_cast<std::uint32_t>(std::atoi(argv[3])) : 20); }
+	if(argc > 1) { return Unpack(argv[1], argc > 2 ? argv[2] : nullptr); }
+
+	std::fprintf(stderr, "logunpack <log> [out.txt]\nlogunpack -b <plain.txt> [iterations]\n");
+	return 1;
+}
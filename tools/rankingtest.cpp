@@ -0,0 +1,253 @@
+/*
+rankingtest
+Ranks a hand picked inventory through RankingEngine<PlainItemPolicy> with the default rules
+and checks the best item of every category, including ties, duplicates, categories nothing
+scores in and a category ranked by custom weights, and that ReferenceRankingEngine agrees.
+Checks that categories where every score is negative still have a best item, then times both
+engines on a synthetic inventory and checks they agree there as well
+
+	rankingtest [iterations]
+
+Builds on Windows and Linux without the game headers
+	g++ -std=c++17 -O2 -I.. rankingtest.cpp ../arena.cpp ../rules.cpp ../scoring.cpp -o rankingtest
+*/
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+#include "../ranking.h"
+#include "inventory.h"
+#include "testing.h"
+
+// Biped slot bits as used by BGSBipedObjectForm
+static const std::uint32_t kSlotHelmet = 1 << 1;
+static const std::uint32_t kSlotBody   = 1 << 2;
+static const std::uint32_t kSlotFeet   = 1 << 7;
+
+struct Fixture
+{
+	const RuleTable&		 table;
+	std::vector<PlainItem>	 items;
+	std::vector<const char*> names;
+
+	explicit Fixture(const RuleTable& table) : table(table) {}
+
+	PlainItem& Add(const char* name, ItemKind kind, std::initializer_list<std::uint32_t> keywords)
+	{
+		PlainItem item;
+		item.kind = kind;
+		for(std::uint32_t formID : keywords) SetKeyword(table, formID, item.keywords);
+		items.push_back(item);
+		names.push_back(name);
+		return items.back();
+	}
+
+	void Weapon(const char* name, WeaponKind type, float damage, float weight, std::initializer_list<std::uint32_t> keywords)
+	{
+		PlainItem& item				 = Add(name, kKind_Weapon, keywords);
+		item.weaponType				 = type;
+		item.metrics[kMetric_Damage] = damage;
+		item.metrics[kMetric_Weight] = weight;
+	}
+
+	void Armor(const char* name, ArmorKind type, std::uint32_t slotMask, float armor, std::initializer_list<std::uint32_t> keywords)
+	{
+		PlainItem& item				= Add(name, kKind_Armor, keywords);
+		item.armorType				= type;
+		item.slotMask				= slotMask;
+		item.metrics[kMetric_Armor] = armor;
+	}
+
+	void Ammo(const char* name, bool bolt, float damage)
+	{
+		PlainItem& item				 = Add(name, kKind_Ammo, {});
+		item.flags					 = bolt ? kItemFlag_Bolt : 0;
+		item.metrics[kMetric_Damage] = damage;
+	}
+};
+
+static int FindCategory(const RuleTable& table, const char* name)
+{
+	for(std::uint32_t c = 0; c < table.numCategories; c++) {
+		if(!std::strcmp(table.categories[c].name, name)) { return static_cast<int>(c); }
+	}
+	return -1;
+}
+
+// The name of the item the best record of a category points to, null when it has none
+static const char* GetWinner(const Fixture& fixture, const std::vector<PlainItemPolicy::Record>& records, const std::vector<std::int32_t>& best, const char* category)
+{
+	int c = FindCategory(fixture.table, category);
+	if(c == -1 || best[c] == -1) { return nullptr; }
+	return fixture.names[records[best[c]].item - fixture.items.data()];
+}
+
+static bool IsWinner(const char* winner, const char* expected)
+{
+	return winner == expected || (winner && expected && !std::strcmp(winner, expected));
+}
+
+static void TestFixture(const RuleTable& table)
+{
+	Fixture fixture(table);
+	fixture.items.reserve(32);
+
+	// Typed by keyword, by the form data alone, or by a keyword disagreeing with the form data
+	fixture.Weapon("Iron Sword", kWeapon_Sword, 7.0f, 9.0f, {0x0001E711});
+	fixture.Weapon("Daedric Sword", kWeapon_Sword, 14.0f, 16.0f, {0x0001E711});
+	fixture.Weapon("Steel Sword", kWeapon_Sword, 8.0f, 10.0f, {});
+	fixture.Weapon("Iron Dagger", kWeapon_Dagger, 4.0f, 2.0f, {0x0001E713});
+	fixture.Weapon("Blade of Woe", kWeapon_Sword, 12.0f, 7.0f, {0x0001E713});
+	fixture.Weapon("Long Bow", kWeapon_Bow, 6.0f, 5.0f, {0x0001E715});
+	fixture.Weapon("Hunting Bow", kWeapon_Bow, 7.0f, 7.0f, {0x0001E715});
+	fixture.Weapon("Crossbow", kWeapon_Crossbow, 19.0f, 14.0f, {0x0001E715});
+	fixture.Weapon("Daedric Mace", kWeapon_Mace, 16.0f, 20.0f, {0x0001E714});
+	fixture.Weapon("Orcish Mace", kWeapon_Mace, 11.0f, 4.0f, {0x0001E714});
+	fixture.Ammo("Iron Arrow", false, 8.0f);
+	fixture.Ammo("Steel Arrow", false, 10.0f);
+	fixture.Ammo("Steel Bolt", true, 10.0f);
+	fixture.Armor("Leather Armor", kArmor_Light, kSlotBody, 26.0f, {0x0006BBD3, 0x0006C0EC});
+	fixture.Armor("Elven Armor", kArmor_Light, kSlotBody, 29.0f, {0x0006BBD3, 0x0006C0EC});
+	fixture.Armor("Iron Boots", kArmor_Heavy, kSlotFeet, 10.0f, {});
+	fixture.Armor("Steel Boots", kArmor_Heavy, kSlotFeet, 15.0f, {0x0006BBD2, 0x0006C0ED});
+	fixture.Armor("Steel Helmet", kArmor_Heavy, kSlotHelmet, 17.0f, {0x0006BBD2, 0x0006C0EE});
+	fixture.Armor("Steel Horned Helmet", kArmor_Heavy, kSlotHelmet, 17.0f, {0x0006BBD2, 0x0006C0EE});
+	fixture.Armor("Hood", kArmor_Clothing, kSlotHelmet, 0.0f, {});
+	fixture.Add("Gold Ring", kKind_None, {});
+
+	// Every item once, then a second stack of a few, the way extra data splits them
+	std::vector<PlainItemPolicy::Record> records;
+	for(const PlainItem& item : fixture.items) records.push_back({&item, -1, 0.0f});
+	for(std::uint32_t i : {1u, 11u, 17u}) records.push_back({&fixture.items[i], -1, 0.0f});
+
+	// Maces are ranked by damage less weight, which favors the light one
+	ScoreWeights weights;
+	std::string	 error;
+	weights.Reset(table);
+	CHECK(weights.SetWeights(FindCategory(table, "1HMace"), "damage 1, weight -1", error));
+
+	Arena					  arena;
+	ArenaScope				  scratch(arena);
+	PlainItemPolicy			  policy;
+	std::vector<std::int32_t> best(table.numCategories);
+	std::uint32_t			  count = static_cast<std::uint32_t>(records.size());
+	RankingEngine<PlainItemPolicy>(arena, table, weights).Rank(policy, records.data(), count, table.numCategories, best.data());
+
+	static const char* const expected[][2] = {
+		{"1HSword", "Daedric Sword"},
+		{"1HDagger", "Blade of Woe"},
+		{"Bow", "Hunting Bow"},
+		{"Crossbow", "Crossbow"},
+		{"1HMace", "Orcish Mace"},
+		{"Arrow", "Steel Arrow"},
+		{"Bolt", "Steel Bolt"},
+		{"LightArmor", "Elven Armor"},
+		{"HeavyBoots", "Steel Boots"},
+		{"HeavyHelmet", "Steel Helmet"},
+		{"ClothingHat", "Hood"},
+		{"HeavyArmor", nullptr},
+	};
+	for(const auto& pair : expected) {
+		const char* winner = GetWinner(fixture, records, best, pair[0]);
+		if(!CHECK(IsWinner(winner, pair[1]))) { std::printf("	%s: expected %s, got %s\n", pair[0], pair[1] ? pair[1] : "none", winner ? winner : "none"); }
+	}
+
+	// Of equal records the first one is the best, a duplicate stack does not take over
+	CHECK(best[FindCategory(table, "1HSword")] == 1);
+	CHECK(best[FindCategory(table, "Arrow")] == 11);
+	CHECK(records[20].category == -1 && records[19].category == FindCategory(table, "ClothingHat"));
+	CHECK(records[records.size() - 3].score == records[1].score);
+
+	std::vector<PlainItemPolicy::Record> reference = records;
+	std::vector<std::int32_t>			 referenceBest(table.numCategories);
+	ReferenceRankingEngine<PlainItemPolicy>(table, weights).Rank(policy, reference.data(), count, table.numCategories, referenceBest.data());
+	for(std::uint32_t i = 0; i < count; i++) CHECK(reference[i].category == records[i].category && reference[i].score == records[i].score);
+	CHECK(referenceBest == best);
+}
+
+// Ranked by weight alone every score is below 0, the lightest item of a category is its best
+static void TestNegativeScores(const RuleTable& table)
+{
+	ScoreWeights weights;
+	std::string	 error;
+	weights.Reset(table);
+	for(std::uint32_t c = 0; c < table.numCategories; c++) CHECK(weights.SetWeights(c, "weight -1", error));
+
+	Arena					  arena;
+	ArenaScope				  scratch(arena);
+	PlainItemPolicy			  policy;
+	Inventory				  inventory;
+	std::vector<std::int32_t> best(table.numCategories);
+	std::vector<std::int32_t> referenceBest(table.numCategories);
+	MakeInventory(table, 300, 800, 39, inventory);
+
+	std::uint32_t						 count	   = static_cast<std::uint32_t>(inventory.records.size());
+	std::vector<PlainItemPolicy::Record> reference = inventory.records;
+	RankingEngine<PlainItemPolicy>(arena, table, weights).Rank(policy, inventory.records.data(), count, table.numCategories, best.data());
+	ReferenceRankingEngine<PlainItemPolicy>(table, weights).Rank(policy, reference.data(), count, table.numCategories, referenceBest.data());
+	CHECK(referenceBest == best);
+
+	std::vector<bool> occupied(table.numCategories, false);
+	std::uint32_t	  numClassified = 0;
+	for(const PlainItemPolicy::Record& record : inventory.records) {
+		if(record.category == -1) { continue; }
+
+		numClassified++;
+		occupied[record.category] = true;
+		CHECK(record.score < 0.0f);
+		CHECK(best[record.category] != -1 && record.score <= inventory.records[best[record.category]].score);
+	}
+	CHECK(numClassified > 0);
+	for(std::uint32_t c = 0; c < table.numCategories; c++) CHECK(occupied[c] == (best[c] != -1));
+}
+
+int main(int argc, char** argv)
+{
+	std::uint32_t iterations = argc > 1 ? static_cast<std::uint32_t>(std::atoi(argv[1])) : 200;
+
+	RuleProgram program;
+	std::string error;
+	if(!CHECK(program.Compile(RuleProgram::GetDefaultRules(), error))) { return Finish("rankingtest"); }
+
+	RuleTable table = program.GetTable();
+	TestFixture(table);
+	TestNegativeScores(table);
+
+	ScoreWeights weights;
+	weights.Reset(table);
+
+	Arena					  arena;
+	PlainItemPolicy			  policy;
+	Inventory				  inventory;
+	std::vector<std::int32_t> best(table.numCategories);
+	std::vector<std::int32_t> referenceBest(table.numCategories);
+	MakeInventory(table, 1500, 4000, 42, inventory);
+
+	std::uint32_t						 count	   = static_cast<std::uint32_t>(inventory.records.size());
+	std::vector<PlainItemPolicy::Record> reference = inventory.records;
+
+	auto rank = [&]() {
+		ArenaScope scratch(arena);
+		RankingEngine<PlainItemPolicy>(arena, table, weights).Rank(policy, inventory.records.data(), count, table.numCategories, best.data());
+	};
+	auto rankReference = [&]() { ReferenceRankingEngine<PlainItemPolicy>(table, weights).Rank(policy, reference.data(), count, table.numCategories, referenceBest.data()); };
+
+	rank();
+	rankReference();
+	for(std::uint32_t i = 0; i < count; i++) CHECK(reference[i].category == inventory.records[i].category && reference[i].score == inventory.records[i].score);
+	CHECK(referenceBest == best);
+
+	double engineNs	   = TimeNs(iterations, [&](std::uint32_t) { rank(); });
+	double referenceNs = TimeNs(iterations, [&](std::uint32_t) { rankReference(); });
+	g_sink			   = g_sink + best[0] + referenceBest[0];
+
+	std::printf("Ranking %u records of %zu forms\n", count, inventory.items.size());
+	std::printf("	RankingEngine           %8.1f us per pass\n", engineNs / 1000.0);
+	std::printf("	ReferenceRankingEngine  %8.1f us per pass\n", referenceNs / 1000.0);
+	return Finish("rankingtest");
+}
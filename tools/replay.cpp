@@ -0,0 +1,149 @@
+/*
+replay
+Ranks an inventory snapshot written by the watchdog or by shadow mode again, checks the result
+against the one recorded and times the ranking engine on it
+
+	replay <snapshot.txt> [rules.txt] [iterations]
+
+Without a rule file the built-in rules are used. Builds on Windows and Linux without the game
+headers
+	g++ -std=c++17 -O2 -I.. replay.cpp ../arena.cpp ../blob.cpp ../rules.cpp ../scoring.cpp ../snapshot.cpp -o replay
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../blob.h"
+#include "../ranking.h"
+#include "../snapshot.h"
+
+// Reads the facts the snapshot recorded, items of one form share a key like in the game
+struct SnapshotPolicy
+{
+	struct Record
+	{
+		const SnapshotItem* item;
+		const void*			key;
+		int					category;
+		float				score;
+	};
+
+	const void*	  GetKey(const Record& record) { return record.key; }
+	ItemKind	  GetKind(const Record& record) { return record.item->facts.kind; }
+	WeaponKind	  GetWeaponType(const Record& record) { return record.item->facts.weaponType; }
+	ArmorKind	  GetArmorType(const Record& record) { return record.item->facts.armorType; }
+	std::uint32_t GetSlotMask(const Record& record) { return record.item->facts.slotMask; }
+	std::uint8_t  GetFlags(const Record& record, ItemKind) { return record.item->facts.flags; }
+	KeywordSet	  GetKeywords(const Record& record) { return record.item->facts.keywords; }
+
+	bool GetPresetScore(const Record& record, int& category, float& score)
+	{
+		if(record.item->presetCategory == -1) { return false; }
+
+		category = record.item->presetCategory;
+		score	 = record.item->presetScore;
+		return true;
+	}
+
+	void GetMetrics(const Record& record, ItemKind, float* metrics)
+	{
+		for(std::uint32_t m = 0; m < kMetric_Count; m++) metrics[m] = record.item->facts.metrics[m];
+	}
+
+	void OnGroup(const Record&, const ItemFacts*, int) {}
+	void OnCompare(const Record&, const Record&) {}
+};
+
+int main(int argc, char** argv)
+{
+	if(argc < 2 || argc > 4) {
+		std::fprintf(stderr, "usage: %s <snapshot.txt> [rules.txt] [iterations]\n", argv[0]);
+		return 2;
+	}
+
+	Snapshot	snapshot;
+	std::string error;
+	if(!ReadSnapshot(argv[1], snapshot, error)) {
+		std::fprintf(stderr, "%s: %s\n", argv[1], error.c_str());
+		return 1;
+	}
+
+	std::string text = RuleProgram::GetDefaultRules();
+	if(argc >= 3) {
+		std::ifstream input(argv[2], std::ios::binary);
+		if(!input) {
+			std::fprintf(stderr, "could not open \"%s\"\n", argv[2]);
+			return 1;
+		}
+		text.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+	}
+	if(HashRuleSource(text.data(), text.size()) != snapshot.rulesHash) { std::fprintf(stderr, "warning: the rules differ from the ones the snapshot was taken with (%s)\n", snapshot.rulesPath.c_str()); }
+
+	RuleProgram program;
+	if(!program.Compile(text.c_str(), error)) {
+		std::fprintf(stderr, "rules: %s\n", error.c_str());
+		return 1;
+	}
+
+	RuleTable table = program.GetTable();
+	if(table.numCategories != snapshot.numRuleCategories) {
+		std::fprintf(stderr, "the rules have %u categories, the snapshot %u\n", table.numCategories, snapshot.numRuleCategories);
+		return 1;
+	}
+
+	ScoreWeights weights;
+	weights.Reset(table);
+	for(std::uint32_t c = 0; c < table.numCategories; c++) weights.SetWeights(c, &snapshot.weights[c * kMetric_Count]);
+
+	std::printf("%s in %s, %zu items, %u categories\n", snapshot.reason.c_str(), snapshot.menu.empty() ? "(unknown menu)" : snapshot.menu.c_str(), snapshot.items.size(), snapshot.numCategories);
+	for(const SnapshotTiming& timing : snapshot.timings) std::printf("	%-10s %8.3f ms\n", timing.phase.c_str(), timing.ms);
+
+	// The first item of every form stands in for its base form, player enchanted entries differ in their flags
+	std::unordered_map<std::uint64_t, const SnapshotItem*> forms;
+	std::vector<SnapshotPolicy::Record>					   records;
+	for(const SnapshotItem& item : snapshot.items) {
+		const SnapshotItem* key = forms.emplace(static_cast<std::uint64_t>(item.facts.flags) << 32 | item.formID, &item).first->second;
+		records.push_back({&item, key, -1, 0.0f});
+	}
+
+	int						  iterations = argc == 4 ? std::max(1, std::atoi(argv[3])) : 1000;
+	Arena					  arena;
+	SnapshotPolicy			  policy;
+	std::vector<std::int32_t> best(snapshot.numCategories);
+
+	RankingEngine<SnapshotPolicy> engine(arena, table, weights);
+	auto						  start = std::chrono::steady_clock::now();
+	for(int i = 0; i < iterations; i++) {
+		ArenaScope scratch(arena);
+		engine.Rank(policy, records.data(), static_cast<std::uint32_t>(records.size()), snapshot.numCategories, best.data());
+	}
+	double microseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / iterations;
+	std::printf("replayed %d times, %.2f us per pass\n", iterations, microseconds);
+
+	std::uint32_t mismatches = 0;
+	for(std::size_t i = 0; i < records.size(); i++) {
+		const SnapshotItem& item = *records[i].item;
+		if(records[i].category == item.category && records[i].score == item.score) { continue; }
+
+		std::printf("mismatch: %08X %s was %d (%g), replayed %d (%g)\n", item.formID, item.name.c_str(), item.category, item.score, records[i].category, records[i].score);
+		mismatches++;
+	}
+
+	for(std::uint32_t c = 0; c < snapshot.numCategories; c++) {
+		if(best[c] == -1) { continue; }
+
+		const char* name = c < table.numCategories ? table.categories[c].name : "potion";
+		std::printf("	%-24s %s (%g)\n", name, records[best[c]].item->name.c_str(), records[best[c]].score);
+	}
+
+	std::printf("%u of %zu items differ from the recorded pass\n", mismatches, records.size());
+	return mismatches ? 1 : 0;
+}
@@ -0,0 +1,84 @@
+/*
+rulec
+Offline compiler turning a rule file into the blob the plugin maps at startup
+
+	rulec BestInClassPP_Rules.txt BestInClassPP_Rules.bin
+
+Builds on Windows and Linux without the game headers
+	g++ -std=c++17 -O2 -I.. rulec.cpp ../rules.cpp ../blob.cpp -o rulec
+*/
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include "../blob.h"
+#include "../rules.h"
+
+// Replaces the blob in one step, the plugin may have the old one mapped and never sees half a file
+static bool ReplaceBlob(const std::string& from, const char* to)
+{
+#ifdef _WIN32
+	return MoveFileExA(from.c_str(), to, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+	return std::rename(from.c_str(), to) == 0;
+#endif
+}
+
+int main(int argc, char** argv)
+{
+	if(argc != 3) {
+		std::fprintf(stderr, "usage: %s <rules.txt> <rules.bin>\n", argv[0]);
+		return 2;
+	}
+
+	std::ifstream input(argv[1], std::ios::binary);
+	if(!input) {
+		std::fprintf(stderr, "could not open \"%s\"\n", argv[1]);
+		return 1;
+	}
+	std::string text((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+
+	RuleProgram program;
+	std::string error;
+	if(!program.Compile(text.c_str(), error)) {
+		std::fprintf(stderr, "%s: %s\n", argv[1], error.c_str());
+		return 1;
+	}
+
+	RuleTable				  table = program.GetTable();
+	std::vector<std::uint8_t> blob;
+	WriteRuleBlob(table, HashRuleSource(text.data(), text.size()), static_cast<std::uint32_t>(text.size()), blob);
+
+	// Read it back the way the plugin does before handing it out
+	const BlobHeader* header = nullptr;
+	RuleTable		  check;
+	if(!ReadRuleBlob(blob.data(), blob.size(), check, header, error)) {
+		std::fprintf(stderr, "internal error, the written blob does not validate: %s\n", error.c_str());
+		return 1;
+	}
+
+	std::string	  temporary = std::string(argv[2]) + ".tmp";
+	std::ofstream output(temporary, std::ios::binary | std::ios::trunc);
+	output.write(reinterpret_cast<const char*>(blob.data()), blob.size());
+	output.close();
+	if(!output) {
+		std::fprintf(stderr, "could not write \"%s\"\n", temporary.c_str());
+		std::remove(temporary.c_str());
+		return 1;
+	}
+	if(!ReplaceBlob(temporary, argv[2])) {
+		std::fprintf(stderr, "could not replace \"%s\"\n", argv[2]);
+		std::remove(temporary.c_str());
+		return 1;
+	}
+
+	std::printf("%u rules, %u categories, %u keywords, %zu bytes\n", table.numRows, table.numCategories, table.numKeywords, blob.size());
+	return 0;
+}
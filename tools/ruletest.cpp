@@ -0,0 +1,487 @@
+/*
+ruletest
+Checks KeywordSet and the rule compiler and classifier against hand picked items, then times
+classification on synthetic keyword sets against scanning each item's keyword array the way
+BGSKeywordForm::HasKeyword does, and the compiled default rules against the same rules written
+as branches
+
+	ruletest [iterations]
+
+Builds on Windows and Linux without the game headers
+	g++ -std=c++17 -O2 -I.. ruletest.cpp ../rules.cpp -o ruletest
+*/
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../rules.h"
+#include "testing.h"
+
+// Vanilla keywords from Skyrim.esm the built-in rules refer to
+static const std::uint32_t kArmorLight	   = 0x0006BBD3;
+static const std::uint32_t kArmorHeavy	   = 0x0006BBD2;
+static const std::uint32_t kArmorCuirass   = 0x0006C0EC;
+static const std::uint32_t kArmorBoots	   = 0x0006C0ED;
+static const std::uint32_t kArmorHelmet	   = 0x0006C0EE;
+static const std::uint32_t kArmorShield	   = 0x000965B2;
+static const std::uint32_t kWeapTypeSword  = 0x0001E711;
+static const std::uint32_t kWeapTypeDagger = 0x0001E713;
+static const std::uint32_t kWeapTypeBow	   = 0x0001E715;
+
+static const std::uint32_t kArmorKeywords[]	 = {kArmorLight, kArmorHeavy};
+static const std::uint32_t kSlotKeywords[]	 = {kArmorCuirass, kArmorBoots, 0x0006C0EF, kArmorHelmet, kArmorShield};
+static const std::uint32_t kWeaponKeywords[] = {kWeapTypeSword, 0x0001E712, 0x0001E714, kWeapTypeDagger, 0x0006D931, 0x0006D932, 0x0006D930};
+
+// Biped slot bits as used by BGSBipedObjectForm
+static const std::uint32_t kSlotHelmet = 1 << 1;
+static const std::uint32_t kSlotBody   = 1 << 2;
+static const std::uint32_t kSlotFeet   = 1 << 7;
+static const std::uint32_t kSlotShield = 1 << 9;
+
+static int FindCategory(const RuleTable& table, const char* name)
+{
+	for(std::uint32_t c = 0; c < table.numCategories; c++) {
+		if(!std::strcmp(table.categories[c].name, name)) { return static_cast<int>(c); }
+	}
+	return -2;
+}
+
+// Keywords the rules do not refer to have no bit and are left out, like KeywordIndex does
+static KeywordSet GetKeywords(const RuleTable& table, std::initializer_list<std::uint32_t> formIDs)
+{
+	KeywordSet set;
+	for(std::uint32_t formID : formIDs) {
+		for(std::uint32_t bit = 0; bit < table.numKeywords; bit++) {
+			if(table.keywordFormIDs[bit] == formID) { set.Set(bit); }
+		}
+	}
+	return set;
+}
+
+static ItemFacts MakeWeapon(const RuleTable& table, WeaponKind type, std::initializer_list<std::uint32_t> keywords)
+{
+	ItemFacts facts;
+	facts.kind		 = kKind_Weapon;
+	facts.weaponType = type;
+	facts.keywords	 = GetKeywords(table, keywords);
+	return facts;
+}
+
+static ItemFacts MakeArmor(const RuleTable& table, ArmorKind type, std::uint32_t slotMask, std::initializer_list<std::uint32_t> keywords)
+{
+	ItemFacts facts;
+	facts.kind		= kKind_Armor;
+	facts.armorType = type;
+	facts.slotMask	= slotMask;
+	facts.keywords	= GetKeywords(table, keywords);
+	return facts;
+}
+
+static int FindBit(const RuleTable& table, std::uint32_t formID)
+{
+	for(std::uint32_t bit = 0; bit < table.numKeywords; bit++) {
+		if(table.keywordFormIDs[bit] == formID) { return static_cast<int>(bit); }
+	}
+	return -1;
+}
+
+static void TestKeywordSet()
+{
+	KeywordSet set;
+	CHECK(set.Empty());
+
+	// Bits on both sides of the word boundary
+	set.Set(0);
+	set.Set(63);
+	set.Set(64);
+	set.Set(KeywordSet::maxBits - 1);
+	CHECK(!set.Empty());
+	CHECK(set.Test(0) && set.Test(63) && set.Test(64) && set.Test(KeywordSet::maxBits - 1));
+	CHECK(!set.Test(1) && !set.Test(62) && !set.Test(65));
+
+	KeywordSet subset;
+	subset.Set(63);
+	subset.Set(64);
+	CHECK(set.ContainsAll(subset));
+	CHECK(!subset.ContainsAll(set));
+	CHECK(set.ContainsAll(KeywordSet()));
+
+	KeywordSet other;
+	other.Set(100);
+	CHECK(!set.Intersects(other));
+	other.Set(KeywordSet::maxBits - 1);
+	CHECK(set.Intersects(other));
+	CHECK(!set.Intersects(KeywordSet()));
+}
+
+static void TestDefaultRules()
+{
+	RuleProgram program;
+	std::string error;
+	if(!CHECK(program.Compile(RuleProgram::GetDefaultRules(), error))) {
+		std::printf("%s\n", error.c_str());
+		return;
+	}
+	RuleTable table = program.GetTable();
+
+	// Dawnguard crossbows carry WeapTypeBow, they still have to land in Crossbow
+	CHECK(table.Classify(MakeWeapon(table, kWeapon_Crossbow, {kWeapTypeBow})) == FindCategory(table, "Crossbow"));
+	CHECK(table.Classify(MakeWeapon(table, kWeapon_Crossbow, {})) == FindCategory(table, "Crossbow"));
+	CHECK(table.Classify(MakeWeapon(table, kWeapon_Bow, {kWeapTypeBow})) == FindCategory(table, "Bow"));
+	CHECK(table.Classify(MakeWeapon(table, kWeapon_Bow, {})) == FindCategory(table, "Bow"));
+
+	// The keyword wins over the weapon type, that is how modded items are sorted
+	CHECK(table.Classify(MakeWeapon(table, kWeapon_Sword, {kWeapTypeDagger})) == FindCategory(table, "1HDagger"));
+	CHECK(table.Classify(MakeWeapon(table, kWeapon_Sword, {kWeapTypeSword})) == FindCategory(table, "1HSword"));
+	CHECK(table.Classify(MakeWeapon(table, kWeapon_Staff, {})) == -1);
+
+	CHECK(table.Classify(MakeArmor(table, kArmor_Light, kSlotBody, {kArmorLight, kArmorCuirass})) == FindCategory(table, "LightArmor"));
+	CHECK(table.Classify(MakeArmor(table, kArmor_Clothing, kSlotBody, {kArmorHeavy, kArmorCuirass})) == FindCategory(table, "HeavyArmor"));
+	CHECK(table.Classify(MakeArmor(table, kArmor_Heavy, kSlotFeet, {})) == FindCategory(table, "HeavyBoots"));
+	CHECK(table.Classify(MakeArmor(table, kArmor_Light, kSlotShield, {kArmorLight, kArmorShield})) == FindCategory(table, "LightShield"));
+	CHECK(table.Classify(MakeArmor(table, kArmor_Clothing, kSlotHelmet, {})) == FindCategory(table, "ClothingHat"));
+
+	// The slot keyword wins over the slot the form occupies
+	CHECK(table.Classify(MakeArmor(table, kArmor_Light, kSlotFeet, {kArmorLight, kArmorHelmet})) == FindCategory(table, "LightHelmet"));
+	CHECK(table.Classify(MakeArmor(table, kArmor_Light, kSlotFeet, {kArmorLight, kArmorBoots})) == FindCategory(table, "LightBoots"));
+
+	ItemFacts arrow;
+	arrow.kind = kKind_Ammo;
+	CHECK(table.Classify(arrow) == FindCategory(table, "Arrow"));
+	arrow.flags = kItemFlag_Bolt;
+	CHECK(table.Classify(arrow) == FindCategory(table, "Bolt"));
+}
+
+static void TestCustomRules()
+{
+	const char* text = R"(
+category FireDagger by damage
+category LightCuirass by armor
+category Other by value
+rule FireDagger: dagger enchanted keyword 0x0001CEAD
+rule LightCuirass: light body weight < 5
+rule Other: weapon not enchanted not keyword 0x0001E711
+)";
+
+	RuleProgram program;
+	std::string error;
+	if(!CHECK(program.Compile(text, error))) {
+		std::printf("%s\n", error.c_str());
+		return;
+	}
+	RuleTable table = program.GetTable();
+	CHECK(table.numKeywords == 2);
+
+	ItemFacts dagger	   = MakeWeapon(table, kWeapon_Dagger, {0x0001CEAD});
+	ItemFacts plain		   = MakeWeapon(table, kWeapon_Dagger, {0x0001CEAD});
+	ItemFacts sword		   = MakeWeapon(table, kWeapon_Sword, {kWeapTypeSword});
+	ItemFacts cuirass	   = MakeArmor(table, kArmor_Light, kSlotBody, {});
+	ItemFacts heavyCuirass = MakeArmor(table, kArmor_Light, kSlotBody, {});
+
+	dagger.flags						 = kItemFlag_Enchanted;
+	cuirass.metrics[kMetric_Weight]		 = 4.99f;
+	heavyCuirass.metrics[kMetric_Weight] = 5.0f;
+
+	CHECK(table.Classify(dagger) == 0);
+	CHECK(table.Classify(plain) == 2);
+	CHECK(table.Classify(sword) == -1);
+	CHECK(table.Classify(cuirass) == 1);
+	CHECK(table.Classify(heavyCuirass) == -1);
+
+	const char* broken[] = {"category A by damage\nrule B: weapon",
+							"category A by damage\nrule A: weapon arrow bolt",
+							"category A by fame",
+							"category A by damage\nrule A: not weapon",
+							"category A by damage\nrule A: slot 62"};
+	for(const char* source : broken) CHECK(!program.Compile(source, error));
+
+	// Every weapon type has a name, fist weapons included
+	CHECK(program.Compile("category Fists by damage\nrule Fists: handtohand", error));
+	table = program.GetTable();
+	CHECK(table.Classify(MakeWeapon(table, kWeapon_HandToHand, {})) == 0);
+	CHECK(table.Classify(MakeWeapon(table, kWeapon_Dagger, {})) == -1);
+
+	// A rule naming no kind is in every kind's range, the first match stays the declared one
+	CHECK(program.Compile("category Tagged by value\ncategory Light by armor\ncategory Any by value\nrule Tagged: keyword 0x00100001\nrule Light: light\nrule Any: enchanted", error));
+	table = program.GetTable();
+	CHECK(table.kindStart[kKind_Weapon + 1] - table.kindStart[kKind_Weapon] == 2);
+	CHECK(table.kindStart[kKind_Armor + 1] - table.kindStart[kKind_Armor] == 3);
+	CHECK(table.kindStart[kKind_Ammo + 1] - table.kindStart[kKind_Ammo] == 2);
+
+	ItemFacts tagged = MakeArmor(table, kArmor_Light, kSlotBody, {0x00100001});
+	ItemFacts light	 = MakeArmor(table, kArmor_Light, kSlotBody, {});
+	ItemFacts staff	 = MakeWeapon(table, kWeapon_Staff, {});
+	ItemFacts arrow;
+
+	arrow.kind	   = kKind_Ammo;
+	arrow.keywords = GetKeywords(table, {0x00100001});
+	light.flags	   = kItemFlag_Enchanted;
+	staff.flags	   = kItemFlag_Enchanted;
+	CHECK(table.Classify(tagged) == 0);
+	CHECK(table.Classify(light) == 1);
+	CHECK(table.Classify(staff) == 2);
+	CHECK(table.Classify(arrow) == 0);
+
+	// More distinct keywords than a KeywordSet has bits
+	std::string tooMany = "category A by damage\nrule A:";
+	for(std::uint32_t i = 0; i <= KeywordSet::maxBits; i++) tooMany += " keyword " + std::to_string(0x00100000 + i);
+	CHECK(!program.Compile(tooMany.c_str(), error));
+}
+
+/*
+The bitset engine against the obvious implementation, each rule scanning the item's keyword
+array for each keyword it names. Both run the same synthetic rules over the same items and
+have to agree on every item
+*/
+struct ScanRule
+{
+	std::vector<std::uint32_t> required;
+	std::vector<std::uint32_t> excluded;
+	int						   category;
+};
+
+static bool HasKeyword(const std::vector<std::uint32_t>& keywords, std::uint32_t formID)
+{
+	for(std::uint32_t keyword : keywords) {
+		if(keyword == formID) { return true; }
+	}
+	return false;
+}
+
+static int ClassifyByScanning(const std::vector<ScanRule>& rules, const std::vector<std::uint32_t>& keywords)
+{
+	for(const ScanRule& rule : rules) {
+		bool matches = true;
+		for(std::uint32_t formID : rule.required) matches = matches && HasKeyword(keywords, formID);
+		for(std::uint32_t formID : rule.excluded) matches = matches && !HasKeyword(keywords, formID);
+		if(matches) { return rule.category; }
+	}
+	return -1;
+}
+
+static void BenchKeywordRules(std::uint32_t iterations)
+{
+	const std::uint32_t numKeywords = 96;
+	const std::uint32_t numRules	= 64;
+	const std::uint32_t numItems	= 4096;
+	std::mt19937		random(26);
+
+	// Every rule requires one to three keywords and may exclude one, the keyword ids are spread
+	// like FormIDs of several plugins
+	std::string			  text = "category A by damage\ncategory B by damage\ncategory C by damage\n";
+	std::vector<ScanRule> scanRules;
+	for(std::uint32_t r = 0; r < numRules; r++) {
+		ScanRule rule;
+		rule.category = static_cast<int>(r % 3);
+		text += "rule " + std::string(1, static_cast<char>('A' + rule.category)) + ": weapon";
+
+		std::uint32_t numRequired = 1 + random() % 3;
+		for(std::uint32_t k = 0; k < numRequired; k++) rule.required.push_back(0x01000800 + (random() % numKeywords) * 0x01000000);
+		if(random() % 2) { rule.excluded.push_back(0x01000800 + (random() % numKeywords) * 0x01000000); }
+
+		for(std::uint32_t formID : rule.required) text += " keyword " + std::to_string(formID);
+		for(std::uint32_t formID : rule.excluded) text += " not keyword " + std::to_string(formID);
+		text += "\n";
+		scanRules.push_back(rule);
+	}
+
+	RuleProgram program;
+	std::string error;
+	if(!CHECK(program.Compile(text.c_str(), error))) {
+		std::printf("%s\n", error.c_str());
+		return;
+	}
+	RuleTable table = program.GetTable();
+
+	// Items carry four to twelve keywords, a few of them unknown to the rules
+	std::vector<ItemFacts>					items(numItems);
+	std::vector<std::vector<std::uint32_t>> itemKeywords(numItems);
+	for(std::uint32_t i = 0; i < numItems; i++) {
+		std::uint32_t numItemKeywords = 4 + random() % 9;
+		for(std::uint32_t k = 0; k < numItemKeywords; k++) itemKeywords[i].push_back(0x01000800 + (random() % (numKeywords + 16)) * 0x01000000);
+
+		items[i].kind = kKind_Weapon;
+		for(std::uint32_t formID : itemKeywords[i]) {
+			for(std::uint32_t bit = 0; bit < table.numKeywords; bit++) {
+				if(table.keywordFormIDs[bit] == formID) { items[i].keywords.Set(bit); }
+			}
+		}
+	}
+
+	std::uint32_t matched = 0;
+	for(std::uint32_t i = 0; i < numItems; i++) {
+		int category = table.Classify(items[i]);
+		CHECK(category == ClassifyByScanning(scanRules, itemKeywords[i]));
+		matched += category != -1;
+	}
+
+	double bitsetNs = TimeNs(iterations * numItems, [&](std::uint32_t i) { g_sink = g_sink + table.Classify(items[i % numItems]); });
+	double scanNs	= TimeNs(iterations * numItems, [&](std::uint32_t i) { g_sink = g_sink + ClassifyByScanning(scanRules, itemKeywords[i % numItems]); });
+
+	std::printf("%u keyword rules over %u keywords, %u of %u items match\n", table.numRows, table.numKeywords, matched, numItems);
+	std::printf("	KeywordSet rows  %6.1f ns per item\n", bitsetNs);
+	std::printf("	keyword scans    %6.1f ns per item\n", scanNs);
+}
+
+/*
+The default rules as the branches they replaced, walking the rows of the item's kind in the
+compiled table is what the rule file costs over them. Keyword bits and categories are looked up once, then every test is
+a bit test like in the table
+*/
+struct BranchRules
+{
+	int armorBits[2];
+	int slotBits[5];
+	int weaponBits[7];
+	int bowBit;
+
+	// Light then heavy, both in the order body, feet, hands, head, shield
+	int armorCategories[2][5];
+	int clothingCategories[4];
+	int weaponCategories[7];
+	int bow, crossbow, arrow, bolt;
+
+	explicit BranchRules(const RuleTable& table)
+	{
+		const char* armorNames[2][5] = {{"LightArmor", "LightBoots", "LightGauntlets", "LightHelmet", "LightShield"}, {"HeavyArmor", "HeavyBoots", "HeavyGauntlets", "HeavyHelmet", "HeavyShield"}};
+		const char* clothingNames[4] = {"ClothingBody", "ClothingShoes", "ClothingGloves", "ClothingHat"};
+		const char* weaponNames[7]	 = {"1HSword", "1HWarAxe", "1HMace", "1HDagger", "2HGreatsword", "2HBattleaxe", "2HBattleaxe"};
+
+		for(std::uint32_t m = 0; m < 2; m++) armorBits[m] = FindBit(table, kArmorKeywords[m]);
+		for(std::uint32_t s = 0; s < 5; s++) slotBits[s] = FindBit(table, kSlotKeywords[s]);
+		for(std::uint32_t w = 0; w < 7; w++) weaponBits[w] = FindBit(table, kWeaponKeywords[w]);
+		bowBit = FindBit(table, kWeapTypeBow);
+
+		for(std::uint32_t m = 0; m < 2; m++) {
+			for(std::uint32_t s = 0; s < 5; s++) armorCategories[m][s] = FindCategory(table, armorNames[m][s]);
+		}
+		for(std::uint32_t s = 0; s < 4; s++) clothingCategories[s] = FindCategory(table, clothingNames[s]);
+		for(std::uint32_t w = 0; w < 7; w++) weaponCategories[w] = FindCategory(table, weaponNames[w]);
+		bow		 = FindCategory(table, "Bow");
+		crossbow = FindCategory(table, "Crossbow");
+		arrow	 = FindCategory(table, "Arrow");
+		bolt	 = FindCategory(table, "Bolt");
+	}
+
+	static int GetSlot(std::uint32_t slotMask)
+	{
+		if(slotMask & kSlotBody) { return 0; }
+		if(slotMask & kSlotFeet) { return 1; }
+		if(slotMask & (1 << 3)) { return 2; }
+		if(slotMask & kSlotHelmet) { return 3; }
+		if(slotMask & kSlotShield) { return 4; }
+		return -1;
+	}
+
+	int Classify(const ItemFacts& facts) const
+	{
+		switch(facts.kind) {
+			case kKind_Armor: {
+				for(std::uint32_t m = 0; m < 2; m++) {
+					if(!facts.keywords.Test(armorBits[m])) { continue; }
+					for(std::uint32_t s = 0; s < 5; s++) {
+						if(facts.keywords.Test(slotBits[s])) { return armorCategories[m][s]; }
+					}
+				}
+
+				int slot = GetSlot(facts.slotMask);
+				if(slot == -1) { return -1; }
+				if(facts.armorType == kArmor_Light) { return armorCategories[0][slot]; }
+				if(facts.armorType == kArmor_Heavy) { return armorCategories[1][slot]; }
+				return facts.armorType == kArmor_Clothing && slot < 4 ? clothingCategories[slot] : -1;
+			}
+			case kKind_Weapon: {
+				for(std::uint32_t w = 0; w < 7; w++) {
+					if(facts.keywords.Test(weaponBits[w])) { return weaponCategories[w]; }
+				}
+				if(facts.weaponType == kWeapon_Crossbow) { return crossbow; }
+				if(facts.keywords.Test(bowBit)) { return bow; }
+
+				switch(facts.weaponType) {
+					case kWeapon_Sword: return weaponCategories[0];
+					case kWeapon_WarAxe: return weaponCategories[1];
+					case kWeapon_Mace: return weaponCategories[2];
+					case kWeapon_Dagger: return weaponCategories[3];
+					case kWeapon_Greatsword: return weaponCategories[4];
+					case kWeapon_Battleaxe: return weaponCategories[5];
+					case kWeapon_Bow: return bow;
+					default: return -1;
+				}
+			}
+			case kKind_Ammo: return facts.flags & kItemFlag_Bolt ? bolt : arrow;
+			default: return -1;
+		}
+	}
+};
+
+static void BenchDefaultRules(std::uint32_t iterations)
+{
+	const std::uint32_t numItems = 4096;
+	std::mt19937		random(27);
+
+	RuleProgram program;
+	std::string error;
+	if(!CHECK(program.Compile(RuleProgram::GetDefaultRules(), error))) {
+		std::printf("%s\n", error.c_str());
+		return;
+	}
+	RuleTable	table = program.GetTable();
+	BranchRules branches(table);
+
+	// An inventory of mostly vanilla items, a third of them without the keywords modded items
+	// often lack, so the fallback rows are taken too
+	const std::uint32_t	   slotMasks[] = {kSlotBody, kSlotFeet, 1 << 3, kSlotHelmet, kSlotShield, 1 << 5};
+	std::vector<ItemFacts> items(numItems);
+	for(ItemFacts& facts : items) {
+		bool tagged = random() % 3 != 0;
+		switch(random() % 8) {
+			case 0:
+			case 1:
+			case 2:
+				facts.kind		 = kKind_Weapon;
+				facts.weaponType = static_cast<WeaponKind>(1 + random() % kWeapon_HandToHand);
+				if(tagged && facts.weaponType <= kWeapon_Battleaxe) { facts.keywords.Set(branches.weaponBits[random() % 7]); }
+				if(tagged && facts.weaponType >= kWeapon_Bow && facts.weaponType <= kWeapon_Crossbow) { facts.keywords.Set(branches.bowBit); }
+				break;
+			case 3:
+				facts.kind	= kKind_Ammo;
+				facts.flags = random() % 4 ? 0 : kItemFlag_Bolt;
+				break;
+			default: {
+				std::uint32_t slot = random() % 6;
+				facts.kind		   = kKind_Armor;
+				facts.armorType	   = static_cast<ArmorKind>(1 + random() % 3);
+				facts.slotMask	   = slotMasks[slot];
+				if(tagged && facts.armorType != kArmor_Clothing) { facts.keywords.Set(branches.armorBits[facts.armorType - 1]); }
+				if(tagged && slot < 5) { facts.keywords.Set(branches.slotBits[slot]); }
+			}
+		}
+	}
+
+	for(const ItemFacts& facts : items) CHECK(table.Classify(facts) == branches.Classify(facts));
+
+	double tableNs	  = TimeNs(iterations * numItems, [&](std::uint32_t i) { g_sink = g_sink + table.Classify(items[i % numItems]); });
+	double branchesNs = TimeNs(iterations * numItems, [&](std::uint32_t i) { g_sink = g_sink + branches.Classify(items[i % numItems]); });
+
+	std::printf("Default rules, %u rows over %u items\n", table.numRows, numItems);
+	std::printf("	compiled table   %6.1f ns per item, %.1fx the branches\n", tableNs, tableNs / branchesNs);
+	std::printf("	branches         %6.1f ns per item\n", branchesNs);
+}
+
+int main(int argc, char** argv)
+{
+	std::uint32_t iterations = argc > 1 ? static_cast<std::uint32_t>(std::atoi(argv[1])) : 50;
+
+	TestKeywordSet();
+	TestDefaultRules();
+	TestCustomRules();
+	BenchKeywordRules(iterations);
+	BenchDefaultRules(iterations);
+	return Finish("ruletest");
+}
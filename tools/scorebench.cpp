@@ -0,0 +1,131 @@
+/*
+scorebench
+Scores the classified items of a synthetic 100k item inventory three ways: reading the one
+metric each category was ranked by before weights existed, ScoreWeights::Score item by item,
+the way RankingEngine does, and filling metric and weight columns for ScoreColumns. With the
+default weights all three have to agree with the single metric, with mixed weights
+ScoreColumns has to give exactly what ScoreWeights::Score does
+
+	scorebench [iterations] [items]
+
+Builds on Windows and Linux without the game headers
+	g++ -std=c++17 -O2 -I.. scorebench.cpp ../rules.cpp ../scoring.cpp -o scorebench
+*/
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "../scoring.h"
+#include "inventory.h"
+#include "testing.h"
+
+struct Scored
+{
+	ItemFacts	  facts;
+	std::uint32_t category;
+};
+
+struct Columns
+{
+	std::vector<float> metrics[kMetric_Count];
+	std::vector<float> weights[kMetric_Count];
+	const float*	   metricColumns[kMetric_Count];
+	const float*	   weightColumns[kMetric_Count];
+
+	explicit Columns(std::size_t count)
+	{
+		for(std::uint32_t m = 0; m < kMetric_Count; m++) {
+			metrics[m].resize(count);
+			weights[m].resize(count);
+			metricColumns[m] = metrics[m].data();
+			weightColumns[m] = weights[m].data();
+		}
+	}
+};
+
+static void SingleMetric(const RuleTable& table, const std::vector<Scored>& items, float* scores)
+{
+	for(std::size_t i = 0; i < items.size(); i++) scores[i] = items[i].facts.metrics[table.categories[items[i].category].metric];
+}
+
+static void ScoreEach(const ScoreWeights& weights, const std::vector<Scored>& items, float* scores)
+{
+	for(std::size_t i = 0; i < items.size(); i++) scores[i] = weights.Score(items[i].facts, items[i].category);
+}
+
+static void ScoreColumnar(const ScoreWeights& weights, const std::vector<Scored>& items, Columns& columns, float* scores)
+{
+	for(std::size_t i = 0; i < items.size(); i++) {
+		const float* categoryWeights = weights.GetWeights(items[i].category);
+		for(std::uint32_t m = 0; m < kMetric_Count; m++) {
+			columns.metrics[m][i] = items[i].facts.metrics[m];
+			columns.weights[m][i] = categoryWeights[m];
+		}
+	}
+	ScoreColumns(columns.metricColumns, columns.weightColumns, static_cast<std::uint32_t>(items.size()), scores);
+}
+
+int main(int argc, char** argv)
+{
+	std::uint32_t iterations = argc > 1 ? static_cast<std::uint32_t>(std::atoi(argv[1])) : 100;
+	std::uint32_t numItems	 = argc > 2 ? static_cast<std::uint32_t>(std::atoi(argv[2])) : 100000;
+
+	RuleProgram program;
+	std::string error;
+	if(!CHECK(program.Compile(RuleProgram::GetDefaultRules(), error))) { return Finish("scorebench"); }
+
+	RuleTable table = program.GetTable();
+	Inventory inventory;
+	MakeInventory(table, numItems, numItems, 39, inventory);
+
+	// Only items the rules put into a category get scored
+	std::vector<Scored> items;
+	for(const PlainItem& item : inventory.items) {
+		Scored scored;
+		scored.facts.kind		= item.kind;
+		scored.facts.weaponType = item.weaponType;
+		scored.facts.armorType	= item.armorType;
+		scored.facts.flags		= item.flags;
+		scored.facts.slotMask	= item.slotMask;
+		scored.facts.keywords	= item.keywords;
+		for(std::uint32_t m = 0; m < kMetric_Count; m++) scored.facts.metrics[m] = item.metrics[m];
+
+		int category = table.Classify(scored.facts);
+		if(category != -1) {
+			scored.category = static_cast<std::uint32_t>(category);
+			items.push_back(scored);
+		}
+	}
+
+	std::size_t		   count = items.size();
+	Columns			   columns(count);
+	std::vector<float> single(count), each(count), columnar(count);
+
+	ScoreWeights weights;
+	weights.Reset(table);
+	SingleMetric(table, items, single.data());
+	ScoreEach(weights, items, each.data());
+	ScoreColumnar(weights, items, columns, columnar.data());
+	for(std::size_t i = 0; i < count; i++) CHECK(each[i] == single[i] && columnar[i] == single[i]);
+
+	for(std::uint32_t c = 0; c < table.numCategories; c++) CHECK(weights.SetWeights(c, "damage 0.7, armor 0.7, speed 0.2, weight -0.1, value 0.001", error));
+	ScoreEach(weights, items, each.data());
+	ScoreColumnar(weights, items, columns, columnar.data());
+	for(std::size_t i = 0; i < count; i++) CHECK(columnar[i] == each[i]);
+
+	double singleNs	  = TimeNs(iterations, [&](std::uint32_t) { SingleMetric(table, items, single.data()); });
+	double eachNs	  = TimeNs(iterations, [&](std::uint32_t) { ScoreEach(weights, items, each.data()); });
+	double columnarNs = TimeNs(iterations, [&](std::uint32_t) { ScoreColumnar(weights, items, columns, columnar.data()); });
+	double kernelNs	  = TimeNs(iterations, [&](std::uint32_t) { ScoreColumns(columns.metricColumns, columns.weightColumns, static_cast<std::uint32_t>(count), columnar.data()); });
+	g_sink			  = g_sink + static_cast<std::uint64_t>(single[0] + each[0] + columnar[0]);
+
+	std::printf("Scoring %zu classified items of %u\n", count, numItems);
+	std::printf("	single metric       %6.2f ns per item\n", singleNs / count);
+	std::printf("	weighted, per item  %6.2f ns per item\n", eachNs / count);
+	std::printf("	weighted, columns   %6.2f ns per item\n", columnarNs / count);
+	std::printf("	ScoreColumns alone  %6.2f ns per item\n", kernelNs / count);
+	return Finish("scorebench");
+}
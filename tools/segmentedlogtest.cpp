@@ -0,0 +1,164 @@
+/*
+segmentedlogtest
+Checks MappedFile creating, cutting and reopening files, and SegmentedLog rolling full
+segments into path.1, path.2 and so on, deleting the ones past its retention, keeping the last
+session's log when it opens an existing file, starting every segment with its header and
+cutting the file to what was written on close. Everything happens in a temporary directory.
+Then times appending lines
+
+	segmentedlogtest [lines]
+
+Builds on Linux without the game headers
+	g++ -std=c++17 -O2 -I.. segmentedlogtest.cpp ../mappedfile.cpp ../segmentedlog.cpp -o segmentedlogtest
+*/
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <unistd.h>
+
+#include "../segmentedlog.h"
+#include "testing.h"
+
+static std::string ReadFile(const std::string& path)
+{
+	std::ifstream file(path, std::ios::binary);
+	return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+static bool Exists(const std::string& path)
+{
+	return access(path.c_str(), F_OK) == 0;
+}
+
+static bool AppendLine(SegmentedLog& log, std::uint32_t number)
+{
+	char		line[16];
+	std::string error;
+	std::snprintf(line, sizeof(line), "line %02u\n", number % 100);
+	return log.Append(line, std::strlen(line), error);
+}
+
+static void TestMappedFile(const std::string& directory)
+{
+	std::string path = directory + "/mapped.bin";
+	MappedFile	file;
+
+	CHECK(!file.Open(path.c_str()));
+	CHECK(!file.Create(path.c_str(), 0));
+
+	// A created file is all zeroes and writable, closing cuts it to what is kept
+	CHECK(file.Create(path.c_str(), 4096));
+	CHECK(file.IsOpen() && file.GetSize() == 4096 && file.GetWritableData());
+	CHECK(file.GetData()[0] == 0 && file.GetData()[4095] == 0);
+	std::memcpy(file.GetWritableData(), "mapped", 6);
+	CHECK(file.Close(6));
+	CHECK(!file.IsOpen());
+	CHECK(ReadFile(path) == "mapped");
+
+	// Reopening maps it read-only
+	CHECK(file.Open(path.c_str()));
+	CHECK(file.GetSize() == 6 && !file.GetWritableData() && !std::memcmp(file.GetData(), "mapped", 6));
+	CHECK(!file.Close(0));
+	CHECK(ReadFile(path) == "mapped");
+
+	// Keeping more than was mapped keeps the whole file, an empty one cannot be mapped
+	CHECK(file.Create(path.c_str(), 16));
+	CHECK(file.Close(100));
+	CHECK(ReadFile(path).size() == 16);
+	std::ofstream(path, std::ios::trunc);
+	CHECK(!file.Open(path.c_str()));
+
+	std::remove(path.c_str());
+}
+
+static void TestSegmentedLog(const std::string& directory)
+{
+	std::string path = directory + "/test.log";
+	std::string error;
+
+	// Eight lines of 8 bytes fill a 64 byte segment, the ninth rolls it
+	SegmentedLog log;
+	CHECK(!AppendLine(log, 0));
+	CHECK(log.Open(path, 64, 3, error));
+	CHECK(log.IsOpen() && log.GetSegmentSize() == 64 && log.GetRetention() == 3);
+	for(std::uint32_t i = 0; i < 8; i++) CHECK(AppendLine(log, i));
+	CHECK(!Exists(path + ".1"));
+	CHECK(AppendLine(log, 8));
+	CHECK(ReadFile(path + ".1") == "line 00\nline 01\nline 02\nline 03\nline 04\nline 05\nline 06\nline 07\n");
+
+	// Until the log is closed the segment is padded with zeroes, then it is cut
+	CHECK(ReadFile(path).size() == 64);
+	log.Close();
+	CHECK(!log.IsOpen());
+	CHECK(ReadFile(path) == "line 08\n");
+
+	// Opening an existing log rolls the last session's one, path.2 is the oldest kept
+	CHECK(log.Open(path, 64, 3, error));
+	CHECK(ReadFile(path + ".1") == "line 08\n");
+	CHECK(ReadFile(path + ".2").compare(0, 8, "line 00\n") == 0);
+
+	// Older segments than the retention allows are deleted
+	for(std::uint32_t i = 10; i < 42; i++) CHECK(AppendLine(log, i));
+	log.Close();
+	CHECK(!Exists(path + ".3"));
+	CHECK(ReadFile(path + ".2") == "line 18\nline 19\nline 20\nline 21\nline 22\nline 23\nline 24\nline 25\n");
+	CHECK(ReadFile(path + ".1") == "line 26\nline 27\nline 28\nline 29\nline 30\nline 31\nline 32\nline 33\n");
+	CHECK(ReadFile(path) == "line 34\nline 35\nline 36\nline 37\nline 38\nline 39\nline 40\nline 41\n");
+
+	// A header starts every segment, a line is cut to the room left after it
+	log.SetHeader("HEAD");
+	CHECK(log.Open(path, 16, 2, error));
+	CHECK(log.Append("0123456789", 10, error));
+	CHECK(log.Append("abcdef", 6, error));
+	CHECK(log.Append("0123456789abcdefXYZ", 19, error));
+	log.Close();
+	CHECK(ReadFile(path + ".1") == "HEADabcdef");
+	CHECK(ReadFile(path) == "HEAD0123456789ab");
+
+	// A retention of 0 still keeps the file being written
+	log.SetHeader("");
+	CHECK(log.Open(path, 64, 0, error));
+	CHECK(log.GetRetention() == 1);
+	log.Close();
+
+	for(const char* suffix : {"", ".1", ".2"}) std::remove((path + suffix).c_str());
+
+	CHECK(!log.Open(directory + "/missing/test.log", 64, 3, error));
+	CHECK(!error.empty());
+}
+
+int main(int argc, char** argv)
+{
+	std::uint32_t numLines = argc > 1 ? static_cast<std::uint32_t>(std::atoi(argv[1])) : 1000000;
+
+	char directory[] = "/tmp/segmentedlogtestXXXXXX";
+	if(!mkdtemp(directory)) {
+		std::printf("could not create a temporary directory\n");
+		return 1;
+	}
+
+	TestMappedFile(directory);
+	TestSegmentedLog(directory);
+
+	// Lines the length of a typical log line into 4 MB segments
+	std::string	 path = std::string(directory) + "/bench.log";
+	std::string	 error;
+	SegmentedLog log;
+	const char	 line[] = "[2026-10-18 12:00:00] The best item of type 1HSword is Daedric Sword\n";
+	CHECK(log.Open(path, 4 * 1024 * 1024, 3, error));
+	double appendNs = TimeNs(numLines, [&](std::uint32_t) { g_sink = g_sink + log.Append(line, sizeof(line) - 1, error); });
+	log.Close();
+
+	std::printf("Appending %u lines of %zu bytes\n", numLines, sizeof(line) - 1);
+	std::printf("	%.1f ns per line\n", appendNs);
+
+	for(const char* suffix : {"", ".1", ".2"}) std::remove((path + suffix).c_str());
+	rmdir(directory);
+	return Finish("segmentedlogtest");
+}
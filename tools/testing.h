@@ -0,0 +1,38 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+/*
+Testing
+What the tests under tools share. A failed CHECK prints its line and condition, main returns
+the number of failures so make check stops on the first test with any
+*/
+static std::uint32_t g_failures = 0;
+
+// Benchmarks add their results here, so the compiler cannot drop the work
+static volatile std::uint64_t g_sink = 0;
+
+#define CHECK(condition) Check((condition), #condition, __LINE__)
+
+inline bool Check(bool passed, const char* condition, int line)
+{
+	if(!passed && g_failures++ < 20) { std::printf("line %d: CHECK(%s) failed\n", line, condition); }
+	return passed;
+}
+
+// Nanoseconds per call of function(i) for i below iterations
+template<class Function>
+inline double TimeNs(std::uint32_t iterations, Function function)
+{
+	auto start = std::chrono::steady_clock::now();
+	for(std::uint32_t i = 0; i < iterations; i++) function(i);
+	return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+inline int Finish(const char* name)
+{
+	std::printf("%s: %s\n", name, g_failures ? "FAILED" : "OK");
+	return g_failures ? 1 : 0;
+}
@@ -0,0 +1,57 @@
+#include "watchdog.h"
+
+#include <cerrno>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#endif
+
+// -1 for files that do not exist, those are filled first
+static std::int64_t GetModifiedTime(const std::string& path)
+{
+#ifdef _WIN32
+	struct _stat64 info;
+	int			   result = _stat64(path.c_str(), &info);
+#else
+	struct stat info;
+	int			result = stat(path.c_str(), &info);
+#endif
+
+	return result == 0 ? static_cast<std::int64_t>(info.st_mtime) : -1;
+}
+
+static bool MakeDirectory(const std::string& directory)
+{
+#ifdef _WIN32
+	int result = _mkdir(directory.c_str());
+#else
+	int result = mkdir(directory.c_str(), 0755);
+#endif
+
+	return result == 0 || errno == EEXIST;
+}
+
+bool WriteRotatingSnapshot(const std::string& directory, std::uint32_t maxSnapshots, const Snapshot& snapshot, std::string& path, std::string& error)
+{
+	if(!MakeDirectory(directory)) {
+		error = "could not create \"" + directory + "\"";
+		return false;
+	}
+
+	// Timestamps only have a resolution of seconds, ties go to the lower slot
+	std::uint32_t oldestSlot = 0;
+	std::int64_t  oldestTime = 0;
+	for(std::uint32_t slot = 0; slot < maxSnapshots; slot++) {
+		std::int64_t modified = GetModifiedTime(directory + "/slow_" + std::to_string(slot) + ".txt");
+		if(slot == 0 || modified < oldestTime) {
+			oldestSlot = slot;
+			oldestTime = modified;
+		}
+		if(modified == -1) { break; }
+	}
+
+	path = directory + "/slow_" + std::to_string(oldestSlot) + ".txt";
+	return WriteSnapshot(path.c_str(), snapshot, error);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include "snapshot.h"
+
+/*
+PassTimings
+Splits a pass into named phases, each Mark ends the phase running since the previous one.
+Phase names must be string literals, the timings only keep the pointers
+*/
+class PassTimings
+{
+	public:
+	static const std::uint32_t maxPhases = 16;
+
+	PassTimings() : start(std::chrono::steady_clock::now()), last(start) {}
+
+	void Mark(const char* phase)
+	{
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		if(numPhases < maxPhases) {
+			phases[numPhases] = phase;
+			times[numPhases]  = std::chrono::duration<double, std::milli>(now - last).count();
+			numPhases++;
+		}
+		last = now;
+	}
+
+	double GetTotalMs() const { return std::chrono::duration<double, std::milli>(last - start).count(); }
+
+	std::uint32_t GetNumPhases() const { return numPhases; }
+	const char*	  GetPhase(std::uint32_t i) const { return phases[i]; }
+	double		  GetPhaseMs(std::uint32_t i) const { return times[i]; }
+	double		  GetLastPhaseMs() const { return numPhases ? times[numPhases - 1] : 0.0; }
+
+	private:
+	std::chrono::steady_clock::time_point start;
+	std::chrono::steady_clock::time_point last;
+	const char*							  phases[maxPhases];
+	double								  times[maxPhases];
+	std::uint32_t						  numPhases = 0;
+};
+
+/*
+Watchdog Snapshots
+A pass over the latency budget leaves a snapshot of its list in the snapshot directory. The
+directory keeps the last maxSnapshots of them as slow_<n>.txt, a new one replaces the oldest.
+tools/replay.cpp ranks them again offline
+*/
+bool WriteRotatingSnapshot(const std::string& directory, std::uint32_t maxSnapshots, const Snapshot& snapshot, std::string& path, std::string& error);